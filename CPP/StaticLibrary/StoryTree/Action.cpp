@@ -1,6 +1,10 @@
 //Action.cpp
 #include "stdafx.h"
 #include "Action.h"
+#include "MemoryReport.h"
+#include "SDB.h"
+
+#include <iostream>
 
 namespace ST{
 
@@ -22,14 +26,18 @@ namespace ST{
 	Action::Action(std::string name, int uid, std::string cls){
 		this->name = name;
 		this->uid = uid;
-		this->cls = cls;
+		if (cls != ""){
+			this->clsID = SymbolTable::global().intern(cls);
+		}
 	}
 
 	Action::Action(std::string name, int uid, bool first, std::string cls){
 		this->name = name;
 		this->uid = uid;
 		this->first = first;
-		this->cls = cls;
+		if (cls != ""){
+			this->clsID = SymbolTable::global().intern(cls);
+		}
 	}
 
 
@@ -49,6 +57,34 @@ namespace ST{
 		this->children.push_back(uid);
 	}
 
+	//Resolves the SDB slot of every precondition and expression.
+	//Returns false, leaving those slots unresolved, if one names a class:type the SDB doesn't have
+	bool Action::bindSlots(const SDB& sdb){
+		bool bound = true;
+		for (auto& pre : this->preconditions){
+			pre.setSlot(sdb.getSlot(pre.getClassID(), pre.getTypeID()));
+			if (pre.getSlot() < 0){
+				std::cout << "Error: There's no SDB class and type called " << pre.getClass() << ":" << pre.getType()
+						  << ". Look in the preconditions of action " << this->uid << "." << std::endl;
+				bound = false;
+			}
+		}
+		for (auto& exp : this->expressions){
+			exp.setSlot(sdb.getSlot(exp.getClassID(), exp.getTypeID()));
+			if (exp.getSlot() < 0){
+				std::cout << "Error: There's no SDB class and type called " << exp.getClass() << ":" << exp.getType()
+						  << ". Look in the expressions of action " << this->uid << "." << std::endl;
+				bound = false;
+			}
+		}
+		return bound;
+	}
+
+	//Needs bindSlots to have run, so the program can read slots directly
+	void Action::compilePreconditions(){
+		this->preconditionProgram.compile(this->preconditions);
+	}
+
 	bool Action::isFirst(){
 		return this->first;
 	}
@@ -64,5 +100,42 @@ namespace ST{
 	bool Action::isLeaf() const{
 		return (this->children.size() == 0);
 	}
-	
-}
\ No newline at end of file
+
+	std::string Action::getName() const{
+		return this->name;
+	}
+
+	int Action::getUID() const{
+		return this->uid;
+	}
+
+	std::string Action::getClass() const{
+		return (this->clsID == SymbolTable::NONE) ? "" : SymbolTable::global().getName(this->clsID);
+	}
+
+	int Action::getClassID() const{
+		return this->clsID;
+	}
+
+	const std::vector<Precondition>& Action::getPreconditions() const{
+		return this->preconditions;
+	}
+
+	const PreconditionProgram& Action::getPreconditionProgram() const{
+		return this->preconditionProgram;
+	}
+
+	const std::vector<Expression>& Action::getExpressions() const{
+		return this->expressions;
+	}
+
+	const std::vector<int>& Action::getChildren() const{
+		return this->children;
+	}
+
+	size_t Action::getMemoryUsage() const{
+		return stringBytes(this->name) + vectorBytes(this->preconditions) + vectorBytes(this->preconditionProgram.getOps()) +
+			vectorBytes(this->expressions) + vectorBytes(this->children);
+	}
+
+}
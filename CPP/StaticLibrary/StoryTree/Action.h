@@ -2,11 +2,14 @@
 #pragma once
 
 #include "Precondition.h"
+#include "PreconditionProgram.h"
 #include "Expression.h"
 
 #include <string>
 #include <vector>
 
+class SDB;
+
 namespace ST{
 	class Action
 	{
@@ -21,19 +24,34 @@ namespace ST{
 		void								addPrecondition(const Precondition& pre);
 		void								addExpression(const Expression& exp);
 		void								addChild(int uid);
+		bool								bindSlots(const SDB& sdb);
+		void								compilePreconditions();
 
 		bool								isFirst();
 		bool								isFirst() const;
 		bool								isLeaf();
 		bool								isLeaf() const;
 
+		std::string							getName() const;
+		int									getUID() const;
+		std::string							getClass() const;
+		int									getClassID() const;
+		const std::vector<Precondition>&	getPreconditions() const;
+		const PreconditionProgram&			getPreconditionProgram() const;
+		const std::vector<Expression>&		getExpressions() const;
+		const std::vector<int>&				getChildren() const;
+		size_t								getMemoryUsage() const;
+
 	private:
+		//The display name is cold, so it stays here and goes into the CompiledTree's own name pool
+		//when the tree is compiled. The class is interned in the SymbolTable
 		std::string							name;
 		int									uid;
 		bool								first = false;
-		std::string							cls = "";
+		int									clsID = SymbolTable::NONE;
 
 		std::vector<Precondition>		preconditions;
+		PreconditionProgram				preconditionProgram;
 		std::vector<Expression>			expressions;
 
 		std::vector<int>					children;
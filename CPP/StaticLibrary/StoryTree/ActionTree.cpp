@@ -2,6 +2,7 @@
 
 #include "stdafx.h"
 #include "ActionTree.h"
+#include "MemoryReport.h"
 
 #include <iostream>
 
@@ -15,13 +16,71 @@ ActionTree::~ActionTree()
 }
 
 void ActionTree::addAction(int uid, const ST::Action& action){
-	if (this->actions.find(uid) != this->actions.end()){
+	auto indexIt = this->indices.find(uid);
+	if (indexIt != this->indices.end()){
 		std::cout << "Warning: An action with the uid '" << uid << "' has already been added to this character. Overriding the last action added." << std::endl;
+		this->actions[indexIt->second] = action;
+		this->duplicates.push_back(uid);
+		return;
 	}
-	this->actions[uid] = action;
+	this->indices[uid] = this->actions.size();
+	this->actions.push_back(action);
 }
 
 void ActionTree::addFirst(int uid, const ST::Action& action){
 	this->firsts.push_back(uid);
 	this->addAction(uid, action);
-}
\ No newline at end of file
+}
+
+const std::vector<int>& ActionTree::getFirsts() const{
+	return this->firsts;
+}
+
+//The pointer is valid until the next action is added
+const ST::Action* ActionTree::getAction(int uid) const{
+	return this->getActionAt(this->getIndex(uid));
+}
+
+//Returns -1 if there's no action with the uid
+int ActionTree::getIndex(int uid) const{
+	auto indexIt = this->indices.find(uid);
+	if (indexIt == this->indices.end()){
+		return -1;
+	}
+	return indexIt->second;
+}
+
+const ST::Action* ActionTree::getActionAt(int index) const{
+	if (index < 0 || index >= (int)this->actions.size()){
+		return NULL;
+	}
+	return &(this->actions[index]);
+}
+
+unsigned int ActionTree::size() const{
+	return this->actions.size();
+}
+
+//Finds cycles, children and firsts with no action, unreachable actions and uids added twice
+ST::ActionTreeReport ActionTree::validate() const{
+	ST::ActionTreeValidator validator;
+	for (auto& action : this->actions){
+		const std::vector<int>& children = action.getChildren();
+		validator.addAction(action.getUID(), children.data(), children.size());
+	}
+	for (auto& first : this->firsts){
+		validator.addFirst(first);
+	}
+
+	ST::ActionTreeReport report = validator.validate();
+	report.duplicates = this->duplicates;
+	return report;
+}
+
+size_t ActionTree::getMemoryUsage() const{
+	size_t bytes = ST::vectorBytes(this->firsts) + ST::vectorBytes(this->actions) + ST::hashMapBytes(this->indices) + ST::vectorBytes(this->duplicates);
+	for (auto& action : this->actions){
+		bytes += action.getMemoryUsage();
+	}
+	return bytes;
+}
@@ -2,6 +2,7 @@
 #pragma once
 
 #include "Action.h"
+#include "ActionTreeValidator.h"
 
 #include <vector>
 #include <string>
@@ -16,9 +17,24 @@ public:
 	void											addFirst(int uid, const ST::Action& action);
 	void											addAction(int uid, const ST::Action& action);
 
+	const std::vector<int>&							getFirsts() const;
+	const ST::Action*								getAction(int uid) const;
+	int												getIndex(int uid) const;
+	const ST::Action*								getActionAt(int index) const;
+	unsigned int									size() const;
+	ST::ActionTreeReport							validate() const;
+	size_t											getMemoryUsage() const;
+
 private:
 
 	std::vector<int>								firsts;
-	std::unordered_map<int, ST::Action>				actions;
+
+	//Actions are numbered 0..size() - 1 in the order they were added, so per-action scratch
+	//space can be a plain array. indices maps a uid to its action's number
+	std::vector<ST::Action>							actions;
+	std::unordered_map<int, int>					indices;
+
+	//uids added again after their first action, for validate
+	std::vector<int>								duplicates;
 };
 
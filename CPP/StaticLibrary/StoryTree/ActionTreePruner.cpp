@@ -0,0 +1,297 @@
+//ActionTreePruner.cpp
+#include "stdafx.h"
+#include "ActionTreePruner.h"
+#include "ActionTree.h"
+#include "Character.h"
+#include "SDB.h"
+
+#include <algorithm>
+#include <climits>
+
+namespace ST{
+
+	ActionTreePruner::ActionTreePruner(const SDB& sdb)
+	{
+		for (unsigned int slot = 0; slot < sdb.getSlotCount(); slot++){
+			const SDBSlot& info = sdb.getSlotInfo(slot);
+			if (info.isBoolean){
+				this->slotMins.push_back(0);
+				this->slotMaxes.push_back(1);
+				continue;
+			}
+			this->slotMins.push_back(std::min(info.min, info.max));
+			this->slotMaxes.push_back(std::max(info.min, info.max));
+			this->widen(slot, info.defaultVal);
+		}
+	}
+
+
+	ActionTreePruner::~ActionTreePruner()
+	{
+	}
+
+	//Takes in the character's current values and every value its actions can set a slot to with '='.
+	//'+' and '-' clamp to the class's range at both ends (see Character::applyExpression), so whatever
+	//their operand's sign they can't take a value outside what's already known
+	void ActionTreePruner::addCharacter(int nameID, const Character& character){
+		this->characters.insert(nameID);
+		for (unsigned int slot = 0; slot < this->slotMins.size(); slot++){
+			this->widen(slot, character.getValue(slot));
+		}
+
+		const CompiledTree& compiled = character.getCompiledTree();
+		if (compiled.isMapped()){
+			const CompiledTreeView& view = compiled.getView();
+			for (unsigned int i = 0; i < view.expressionCount; i++){
+				if (view.expressions[i].opcode == EXP_SET){
+					this->widen(view.expressions[i].slot, view.expressions[i].operand);
+				}
+			}
+			return;
+		}
+
+		const ActionTree& tree = character.getActionTree();
+		for (unsigned int index = 0; index < tree.size(); index++){
+			for (auto& exp : tree.getActionAt(index)->getExpressions()){
+				ExpressionOp op = exp.compile();
+				if (op.opcode == EXP_SET){
+					this->widen(op.slot, op.operand);
+				}
+			}
+		}
+	}
+
+	//Walks tree's actions parents before children, carrying the bounds every path to an action passes
+	//through, then walks back up to take out actions left with nothing below them.
+	//A tree with a cycle is left as it is
+	void ActionTreePruner::prune(const ActionTree& tree){
+		unsigned int size = tree.size();
+		this->report = PruneReport();
+		this->live.assign(size, true);
+		this->childBegins.assign(1, 0);
+		this->preBegins.assign(1, 0);
+
+		//Children resolved to indices, -1 where there's no action with the uid
+		std::vector<int> children;
+		std::vector<unsigned int> parentCounts(size, 0);
+		for (unsigned int index = 0; index < size; index++){
+			const Action* action = tree.getActionAt(index);
+			for (auto& child : action->getChildren()){
+				int childIndex = tree.getIndex(child);
+				children.push_back(childIndex);
+				if (childIndex >= 0){
+					parentCounts[childIndex]++;
+				}
+			}
+			this->childBegins.push_back(children.size());
+			this->preBegins.push_back(this->preBegins.back() + action->getPreconditionProgram().getOps().size());
+		}
+		this->childKept.assign(children.size(), true);
+		this->preKept.assign(this->preBegins.back(), true);
+
+		std::vector<int> order;
+		for (unsigned int index = 0; index < size; index++){
+			if (parentCounts[index] == 0){
+				order.push_back(index);
+			}
+		}
+		for (unsigned int next = 0; next < order.size(); next++){
+			for (unsigned int i = this->childBegins[order[next]]; i < this->childBegins[order[next] + 1]; i++){
+				if (children[i] >= 0 && --parentCounts[children[i]] == 0){
+					order.push_back(children[i]);
+				}
+			}
+		}
+		if (order.size() < size){
+			return;
+		}
+
+		//entries[i] bounds what every path into action i allows. A first can be reached with any values
+		std::vector<Bounds> entries(size);
+		std::vector<bool> entered(size, false);
+		std::vector<bool> reached(size, false);
+		for (auto& first : tree.getFirsts()){
+			int firstIndex = tree.getIndex(first);
+			if (firstIndex >= 0){
+				entered[firstIndex] = true;
+				reached[firstIndex] = true;
+			}
+		}
+
+		bool implied;
+		for (auto& index : order){
+			if (!reached[index]){
+				continue;
+			}
+			if (!entered[index]){
+				this->live[index] = false;
+			}
+
+			//Bounds on leaving the action. Later preconditions can be implied by earlier ones too
+			Bounds& bounds = entries[index];
+			const std::vector<PreconditionOp>& ops = tree.getActionAt(index)->getPreconditionProgram().getOps();
+			for (unsigned int i = 0; i < ops.size() && this->live[index]; i++){
+				this->live[index] = this->narrow(bounds, ops[i].character, ops[i].slot, ops[i].opcode, ops[i].operand, implied);
+				this->preKept[this->preBegins[index] + i] = !implied;
+			}
+
+			for (unsigned int i = this->childBegins[index]; i < this->childBegins[index + 1]; i++){
+				int child = children[i];
+				if (child < 0){
+					continue;
+				}
+				reached[child] = true;
+				if (!this->live[index]){
+					continue;
+				}
+
+				Bounds childBounds = bounds;
+				const std::vector<PreconditionOp>& childOps = tree.getActionAt(child)->getPreconditionProgram().getOps();
+				bool passes = true;
+				for (unsigned int pre = 0; pre < childOps.size() && passes; pre++){
+					passes = this->narrow(childBounds, childOps[pre].character, childOps[pre].slot, childOps[pre].opcode, childOps[pre].operand, implied);
+				}
+				if (!passes){
+					this->childKept[i] = false;
+				}
+				else if (!entered[child]){
+					entries[child] = bounds;
+					entered[child] = true;
+				}
+				else {
+					this->join(entries[child], bounds);
+				}
+			}
+			Bounds().swap(bounds);
+		}
+
+		for (auto index = order.rbegin(); index != order.rend(); ++index){
+			if (!reached[*index] || !this->live[*index]){
+				continue;
+			}
+			bool anyChild = false;
+			for (unsigned int i = this->childBegins[*index]; i < this->childBegins[*index + 1]; i++){
+				int child = children[i];
+				if (child >= 0 && this->childKept[i] && !this->live[child]){
+					this->childKept[i] = false;
+				}
+				anyChild = anyChild || (child >= 0 && this->childKept[i]);
+			}
+			if (!anyChild && !tree.getActionAt(*index)->isLeaf()){
+				this->live[*index] = false;
+			}
+		}
+
+		for (unsigned int index = 0; index < size; index++){
+			int uid = tree.getActionAt(index)->getUID();
+			if (!this->live[index]){
+				this->report.deadActions.push_back(uid);
+				continue;
+			}
+			for (unsigned int i = this->childBegins[index]; i < this->childBegins[index + 1]; i++){
+				if (!this->childKept[i] && this->live[children[i]]){
+					this->report.deadLinks.push_back(std::make_pair(uid, tree.getActionAt(children[i])->getUID()));
+				}
+			}
+			for (unsigned int i = this->preBegins[index]; i < this->preBegins[index + 1]; i++){
+				if (!this->preKept[i]){
+					this->report.impliedPreconditions.push_back(std::make_pair(uid, i - this->preBegins[index]));
+				}
+			}
+		}
+	}
+
+	bool ActionTreePruner::isLive(int index) const{
+		return this->live[index];
+	}
+
+	//child is the position in the action's children
+	bool ActionTreePruner::keepsChild(int index, unsigned int child) const{
+		return this->live[index] && this->childKept[this->childBegins[index] + child];
+	}
+
+	bool ActionTreePruner::keepsPrecondition(int index, unsigned int precondition) const{
+		return this->live[index] && this->preKept[this->preBegins[index] + precondition];
+	}
+
+	const PruneReport& ActionTreePruner::getReport() const{
+		return this->report;
+	}
+
+	void ActionTreePruner::widen(int slot, int value){
+		if (slot < 0 || slot >= (int)this->slotMins.size()){
+			return;
+		}
+		this->slotMins[slot] = std::min(this->slotMins[slot], (long long)value);
+		this->slotMaxes[slot] = std::max(this->slotMaxes[slot], (long long)value);
+	}
+
+	//Narrows bounds by a precondition op. Returns false if nothing in bounds passes it; implied is
+	//whether everything in bounds already did. Bounds are kept sorted by character, then slot
+	bool ActionTreePruner::narrow(Bounds& bounds, int character, int slot, int opcode, int operand, bool& implied) const{
+		implied = false;
+		if (opcode == PRE_FAIL || this->characters.count(character) == 0){
+			return false;
+		}
+		if (slot < 0 || slot >= (int)this->slotMins.size()){
+			return true;
+		}
+
+		auto bound = std::lower_bound(bounds.begin(), bounds.end(), std::make_pair(character, slot), [](const Bound& a, const std::pair<int, int>& b){
+			return (a.character != b.first) ? a.character < b.first : a.slot < b.second;
+		});
+		bool found = (bound != bounds.end() && bound->character == character && bound->slot == slot);
+		long long min = found ? bound->min : this->slotMins[slot];
+		long long max = found ? bound->max : this->slotMaxes[slot];
+
+		//'<' and '>' together is the one opcode that isn't a range. Only its ends can be cut off
+		long long value = operand;
+		long long passMin = (opcode & PRE_LESS) ? LLONG_MIN : ((opcode & PRE_EQUAL) ? value : value + 1);
+		long long passMax = (opcode & PRE_GREATER) ? LLONG_MAX : ((opcode & PRE_EQUAL) ? value : value - 1);
+		if (opcode == (PRE_LESS | PRE_GREATER)){
+			implied = (value < min || value > max);
+			min += (min == value) ? 1 : 0;
+			max -= (max == value) ? 1 : 0;
+		}
+		else {
+			implied = (min >= passMin && max <= passMax);
+			min = std::max(min, passMin);
+			max = std::min(max, passMax);
+		}
+		if (min > max){
+			implied = false;
+			return false;
+		}
+
+		if (!found){
+			Bound added = { character, slot, min, max };
+			bounds.insert(bound, added);
+		}
+		else {
+			bound->min = min;
+			bound->max = max;
+		}
+		return true;
+	}
+
+	//Widens into to also allow everything from allows. A slot either doesn't bound is left out
+	void ActionTreePruner::join(Bounds& into, const Bounds& from) const{
+		unsigned int kept = 0;
+		unsigned int other = 0;
+		for (unsigned int i = 0; i < into.size(); i++){
+			while (other < from.size() && (from[other].character != into[i].character ? from[other].character < into[i].character : from[other].slot < into[i].slot)){
+				other++;
+			}
+			if (other == from.size() || from[other].character != into[i].character || from[other].slot != into[i].slot){
+				continue;
+			}
+			into[kept].character = into[i].character;
+			into[kept].slot = into[i].slot;
+			into[kept].min = std::min(into[i].min, from[other].min);
+			into[kept].max = std::max(into[i].max, from[other].max);
+			kept++;
+		}
+		into.resize(kept);
+	}
+
+}
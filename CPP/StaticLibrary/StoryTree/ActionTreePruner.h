@@ -0,0 +1,78 @@
+//ActionTreePruner.h
+#ifndef ActionTreePruner_H
+#define ActionTreePruner_H
+
+#include "stdafx.h"
+
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class SDB;
+class Character;
+class ActionTree;
+
+namespace ST{
+
+	//What an ActionTreePruner took out of a tree, by uid
+	struct PruneReport{
+		std::vector<int>							deadActions;		//actions no traversal can pass
+		std::vector<std::pair<int, int>>			deadLinks;			//(parent, child) where passing the parent rules out the child
+		std::vector<std::pair<int, unsigned int>>	impliedPreconditions;	//(action, index) already guaranteed by every path to the action
+	};
+
+	//Works out which parts of an ActionTree can never matter, from the range of values each SDB slot can hold.
+	//Every action on a path is checked against the same values, so an action's preconditions narrow the
+	//values its children can see. A child whose preconditions can't hold within what every path to it allows
+	//is dead, and a precondition every path already guarantees is dropped. A non-leaf action left without
+	//children is dead too, since it can't end a path.
+	//Slots hold their class's range, widened by any value a character starts with or an '=' can set.
+	//Add every character before pruning any tree, since preconditions may read any of them
+	class ActionTreePruner
+	{
+	public:
+		ActionTreePruner(const SDB& sdb);
+		~ActionTreePruner();
+
+		void										addCharacter(int nameID, const Character& character);
+		void										prune(const ActionTree& tree);
+
+		//Answers for the tree last pruned, by ActionTree index
+		bool										isLive(int index) const;
+		bool										keepsChild(int index, unsigned int child) const;
+		bool										keepsPrecondition(int index, unsigned int precondition) const;
+		const PruneReport&							getReport() const;
+
+	private:
+		//The values one character's slot can hold along a path
+		struct Bound{
+			int										character;
+			int										slot;
+			long long								min;
+			long long								max;
+		};
+		typedef std::vector<Bound>					Bounds;
+
+		//Every slot's range, and the characters that exist. A precondition on anyone else never holds
+		std::vector<long long>						slotMins;
+		std::vector<long long>						slotMaxes;
+		std::unordered_set<int>						characters;
+
+		//Results of the last prune. Children and preconditions are flat, action i's are
+		//[childBegins[i], childBegins[i + 1]) and [preBegins[i], preBegins[i + 1])
+		std::vector<bool>							live;
+		std::vector<unsigned int>					childBegins;
+		std::vector<bool>							childKept;
+		std::vector<unsigned int>					preBegins;
+		std::vector<bool>							preKept;
+		PruneReport									report;
+
+		//private functions for prune
+		void										widen(int slot, int value);
+		bool										narrow(Bounds& bounds, int character, int slot, int opcode, int operand, bool& implied) const;
+		void										join(Bounds& into, const Bounds& from) const;
+	};
+
+}
+
+#endif
@@ -0,0 +1,173 @@
+//ActionTreeValidator.cpp
+#include "stdafx.h"
+#include "ActionTreeValidator.h"
+
+#include <algorithm>
+#include <unordered_map>
+
+namespace ST{
+
+	bool ActionTreeReport::isValid() const{
+		return this->duplicates.empty() && this->danglingChildren.empty() && this->danglingFirsts.empty() && this->cycles.empty();
+	}
+
+	ActionTreeValidator::ActionTreeValidator()
+	{
+		this->childBegins.push_back(0);
+	}
+
+
+	ActionTreeValidator::~ActionTreeValidator()
+	{
+	}
+
+	void ActionTreeValidator::addAction(int uid, const int* children, unsigned int childCount){
+		this->uids.push_back(uid);
+		this->children.insert(this->children.end(), children, children + childCount);
+		this->childBegins.push_back(this->children.size());
+	}
+
+	void ActionTreeValidator::addFirst(int uid){
+		this->firsts.push_back(uid);
+	}
+
+	ActionTreeReport ActionTreeValidator::validate() const{
+		ActionTreeReport report;
+
+		//Number the distinct uids in the order they were first added. definition[vertex] is the
+		//last added action with that uid, whose children count
+		std::unordered_map<int, int> vertices;
+		vertices.reserve(this->uids.size());
+		std::vector<int> vertexUIDs;
+		std::vector<int> definition;
+		for (unsigned int action = 0; action < this->uids.size(); action++){
+			auto inserted = vertices.insert(std::make_pair(this->uids[action], (int)vertexUIDs.size()));
+			if (inserted.second){
+				vertexUIDs.push_back(this->uids[action]);
+				definition.push_back(action);
+			}
+			else {
+				report.duplicates.push_back(this->uids[action]);
+				definition[inserted.first->second] = action;
+			}
+		}
+		unsigned int vertexCount = vertexUIDs.size();
+
+		//Resolve child uids into a CSR edge list over vertices
+		std::vector<unsigned int> edgeBegins(vertexCount + 1, 0);
+		std::vector<int> edges;
+		edges.reserve(this->children.size());
+		for (unsigned int vertex = 0; vertex < vertexCount; vertex++){
+			int action = definition[vertex];
+			for (unsigned int i = this->childBegins[action]; i < this->childBegins[action + 1]; i++){
+				auto childIt = vertices.find(this->children[i]);
+				if (childIt == vertices.end()){
+					report.danglingChildren.push_back(std::make_pair(vertexUIDs[vertex], this->children[i]));
+					continue;
+				}
+				edges.push_back(childIt->second);
+			}
+			edgeBegins[vertex + 1] = edges.size();
+		}
+
+		//Everything reachable from a first
+		std::vector<bool> reached(vertexCount, false);
+		std::vector<int> stack;
+		for (auto& first : this->firsts){
+			auto firstIt = vertices.find(first);
+			if (firstIt == vertices.end()){
+				report.danglingFirsts.push_back(first);
+				continue;
+			}
+			if (!reached[firstIt->second]){
+				reached[firstIt->second] = true;
+				stack.push_back(firstIt->second);
+			}
+			while (!stack.empty()){
+				int vertex = stack.back();
+				stack.pop_back();
+				for (unsigned int edge = edgeBegins[vertex]; edge < edgeBegins[vertex + 1]; edge++){
+					if (!reached[edges[edge]]){
+						reached[edges[edge]] = true;
+						stack.push_back(edges[edge]);
+					}
+				}
+			}
+		}
+		for (unsigned int vertex = 0; vertex < vertexCount; vertex++){
+			if (!reached[vertex]){
+				report.unreachable.push_back(vertexUIDs[vertex]);
+			}
+		}
+
+		//Tarjan's strongly connected components, with an explicit call stack of (vertex, next edge).
+		//A component of more than one action, or one action that is its own child, is a cycle
+		const int UNVISITED = -1;
+		std::vector<int> order(vertexCount, UNVISITED);
+		std::vector<int> lowLink(vertexCount, 0);
+		std::vector<bool> onStack(vertexCount, false);
+		std::vector<std::pair<int, unsigned int>> calls;
+		int nextOrder = 0;
+		for (unsigned int root = 0; root < vertexCount; root++){
+			if (order[root] != UNVISITED){
+				continue;
+			}
+			calls.push_back(std::make_pair((int)root, edgeBegins[root]));
+			order[root] = lowLink[root] = nextOrder++;
+			stack.push_back(root);
+			onStack[root] = true;
+
+			while (!calls.empty()){
+				int vertex = calls.back().first;
+				unsigned int& edge = calls.back().second;
+
+				if (edge < edgeBegins[vertex + 1]){
+					int child = edges[edge++];
+					if (order[child] == UNVISITED){
+						order[child] = lowLink[child] = nextOrder++;
+						stack.push_back(child);
+						onStack[child] = true;
+						calls.push_back(std::make_pair(child, edgeBegins[child]));
+					}
+					else if (onStack[child]){
+						lowLink[vertex] = std::min(lowLink[vertex], order[child]);
+					}
+					continue;
+				}
+
+				calls.pop_back();
+				if (!calls.empty()){
+					int parent = calls.back().first;
+					lowLink[parent] = std::min(lowLink[parent], lowLink[vertex]);
+				}
+				if (lowLink[vertex] != order[vertex]){
+					continue;
+				}
+
+				std::vector<int> component;
+				int member;
+				do {
+					member = stack.back();
+					stack.pop_back();
+					onStack[member] = false;
+					component.push_back(member);
+				} while (member != vertex);
+
+				bool selfLoop = false;
+				for (unsigned int i = edgeBegins[vertex]; i < edgeBegins[vertex + 1] && !selfLoop; i++){
+					selfLoop = (edges[i] == vertex);
+				}
+				if (component.size() > 1 || selfLoop){
+					std::sort(component.begin(), component.end());
+					std::vector<int> cycle;
+					for (auto& inCycle : component){
+						cycle.push_back(vertexUIDs[inCycle]);
+					}
+					report.cycles.push_back(cycle);
+				}
+			}
+		}
+		return report;
+	}
+
+}
@@ -0,0 +1,48 @@
+//ActionTreeValidator.h
+#ifndef ActionTreeValidator_H
+#define ActionTreeValidator_H
+
+#include "stdafx.h"
+
+#include <utility>
+#include <vector>
+
+namespace ST{
+
+	//Everything an ActionTreeValidator found, by uid, in the order the actions were added
+	struct ActionTreeReport{
+		std::vector<int>							duplicates;			//uids added more than once
+		std::vector<std::pair<int, int>>			danglingChildren;	//(parent, child) where child was never added
+		std::vector<int>							danglingFirsts;		//firsts that were never added
+		std::vector<std::vector<int>>				cycles;				//sets of actions that lead back to themselves
+		std::vector<int>							unreachable;		//actions no first leads to
+
+		//Unreachable actions are allowed, they just never come up as options
+		bool										isValid() const;
+	};
+
+	//Checks an action graph in time linear in its actions and child links, so large content can be
+	//validated at load. Cycles come from an iterative Tarjan pass, so deep trees can't overflow the stack
+	//and an action shared by many parents is only visited once.
+	//An action added again replaces the first one's children, like ActionTree::addAction
+	class ActionTreeValidator
+	{
+	public:
+		ActionTreeValidator();
+		~ActionTreeValidator();
+
+		void										addAction(int uid, const int* children, unsigned int childCount);
+		void										addFirst(int uid);
+		ActionTreeReport							validate() const;
+
+	private:
+		//Each added action's uid and its children's uids, children[childBegins[i], childBegins[i + 1])
+		std::vector<int>							uids;
+		std::vector<unsigned int>					childBegins;
+		std::vector<int>							children;
+		std::vector<int>							firsts;
+	};
+
+}
+
+#endif
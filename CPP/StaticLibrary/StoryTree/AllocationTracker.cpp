@@ -0,0 +1,77 @@
+//AllocationTracker.cpp
+#include "stdafx.h"
+#include "AllocationTracker.h"
+
+#include <atomic>
+#include <cstdlib>
+
+namespace ST{
+
+	//In front of every block. Two words, so blocks stay as aligned as malloc's
+	struct BlockHeader{
+		size_t										size;
+		size_t										counted;
+	};
+
+	//Plain globals rather than members, since operator new can run before any constructor does
+	static std::atomic<bool>						enabled(false);
+	static std::atomic<unsigned long long>			allocations(0);
+	static std::atomic<unsigned long long>			frees(0);
+	static std::atomic<long long>					liveBytes(0);
+	static std::atomic<long long>					peakBytes(0);
+
+	void* AllocationTracker::allocate(size_t size){
+		BlockHeader* header = (BlockHeader*)malloc(sizeof(BlockHeader) + (size == 0 ? 1 : size));
+		if (header == NULL){
+			return NULL;
+		}
+		header->size = size;
+		header->counted = enabled.load(std::memory_order_relaxed) ? 1 : 0;
+		if (header->counted){
+			allocations++;
+			long long live = (liveBytes += (long long)size);
+			long long peak = peakBytes.load();
+			while (live > peak && !peakBytes.compare_exchange_weak(peak, live)){
+			}
+		}
+		return header + 1;
+	}
+
+	void AllocationTracker::release(void* block){
+		if (block == NULL){
+			return;
+		}
+		BlockHeader* header = (BlockHeader*)block - 1;
+		if (header->counted){
+			frees++;
+			liveBytes -= (long long)header->size;
+		}
+		free(header);
+	}
+
+	void AllocationTracker::setEnabled(bool enable){
+		enabled.store(enable);
+	}
+
+	bool AllocationTracker::isEnabled(){
+		return enabled.load();
+	}
+
+	AllocationStats AllocationTracker::getStats(){
+		AllocationStats stats;
+		stats.allocations = allocations.load();
+		stats.frees = frees.load();
+		stats.liveBytes = liveBytes.load();
+		stats.peakBytes = peakBytes.load();
+		return stats;
+	}
+
+	//Zeroes the counts and lowers the peak to what's live now. liveBytes itself is kept, since the
+	//blocks it counts will still come off it when they're freed
+	void AllocationTracker::resetStats(){
+		allocations.store(0);
+		frees.store(0);
+		peakBytes.store(liveBytes.load());
+	}
+
+}
@@ -0,0 +1,59 @@
+//AllocationTracker.h
+#ifndef AllocationTracker_H
+#define AllocationTracker_H
+
+#include "stdafx.h"
+
+#include <cstddef>
+#include <new>
+
+namespace ST{
+
+	struct AllocationStats{
+		unsigned long long							allocations = 0;
+		unsigned long long							frees = 0;
+		long long									liveBytes = 0;
+		long long									peakBytes = 0;
+	};
+
+	//A counting allocator. Every block carries its size in front of it, so freeing one can take its bytes
+	//back off the count; blocks allocated while tracking was off aren't counted when they're freed either.
+	//The library never allocates through it itself. A program routes all of its allocations, the library's
+	//included, through it with ST_COUNT_GLOBAL_ALLOCATIONS, then turns tracking on around what it measures
+	class AllocationTracker
+	{
+	public:
+		static void*								allocate(size_t size);
+		static void									release(void* block);
+
+		static void									setEnabled(bool enabled);
+		static bool									isEnabled();
+		static AllocationStats						getStats();
+		static void									resetStats();
+	};
+
+}
+
+//Replaces the global operator new and delete with ST::AllocationTracker's. Use it once, in a .cpp of the
+//program, never of a library. The sized deletes are the ones C++14 compilers call when they know the size
+#define ST_COUNT_GLOBAL_ALLOCATIONS() \
+	void* operator new(size_t size){ \
+		void* block = ST::AllocationTracker::allocate(size); \
+		if (block == NULL){ throw std::bad_alloc(); } \
+		return block; \
+	} \
+	void* operator new[](size_t size){ \
+		void* block = ST::AllocationTracker::allocate(size); \
+		if (block == NULL){ throw std::bad_alloc(); } \
+		return block; \
+	} \
+	void* operator new(size_t size, const std::nothrow_t&) throw(){ return ST::AllocationTracker::allocate(size); } \
+	void* operator new[](size_t size, const std::nothrow_t&) throw(){ return ST::AllocationTracker::allocate(size); } \
+	void operator delete(void* block) throw(){ ST::AllocationTracker::release(block); } \
+	void operator delete[](void* block) throw(){ ST::AllocationTracker::release(block); } \
+	void operator delete(void* block, size_t) throw(){ ST::AllocationTracker::release(block); } \
+	void operator delete[](void* block, size_t) throw(){ ST::AllocationTracker::release(block); } \
+	void operator delete(void* block, const std::nothrow_t&) throw(){ ST::AllocationTracker::release(block); } \
+	void operator delete[](void* block, const std::nothrow_t&) throw(){ ST::AllocationTracker::release(block); }
+
+#endif
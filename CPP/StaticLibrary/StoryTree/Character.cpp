@@ -1,6 +1,11 @@
 //Character.cpp
 #include "stdafx.h"
 #include "Character.h"
+#include "SymbolTable.h"
+#include "SDB.h"
+
+#include <algorithm>
+#include <iostream>
 
 
 Character::Character()
@@ -20,27 +25,106 @@ std::string Character::getName(){
 	return this->name;
 }
 
+void Character::bindSDB(const SDB* sdb){
+	this->sdb = sdb;
+	this->syncSlots();
+}
+
+//Gives any slots the SDB has added since the last sync their default value
+void Character::syncSlots(){
+	if (this->sdb == NULL){
+		return;
+	}
+	for (unsigned int slot = this->values.size(); slot < this->sdb->getSlotCount(); slot++){
+		this->values.push_back(this->sdb->getSlotInfo(slot).defaultVal);
+		this->versions.push_back(0);
+	}
+}
+
 void Character::addCharacteristic(const ST::Characteristic& characteristic){
-	this->characteristics[characteristic.getClass()][characteristic.getType()] = characteristic;
+	int slot = (this->sdb == NULL) ? -1 : this->sdb->getSlot(characteristic.getClassID(), characteristic.getTypeID());
+	if (slot < 0){
+		std::cout << "Character::addCharacteristic() error: There's no SDB class and type called " << characteristic.getClass()
+				  << ":" << characteristic.getType() << std::endl;
+		return;
+	}
+
+	if (characteristic.boolean()){
+		this->values[slot] = characteristic.getBoolValue() ? 1 : 0;
+	}
+	else {
+		this->values[slot] = characteristic.getIntValue();
+	}
+	this->versions[slot]++;
 }
 
 void Character::parseExpression(std::string cls, std::string type, std::string operation, int value){
-	auto clsIt = this->characteristics.find(cls);
-	if (clsIt != this->characteristics.end()){
-		auto typeIt = clsIt->second.find(type);
-		if (typeIt != clsIt->second.end()){
-			typeIt->second.parseExpression(operation, value);
-		}
+	ST::SymbolTable& symbols = ST::SymbolTable::global();
+	int slot = (this->sdb == NULL) ? -1 : this->sdb->getSlot(symbols.find(cls), symbols.find(type));
+	if (slot >= 0){
+		this->parseExpression(slot, operation, value);
 	}
 }
 
 void Character::parseExpression(std::string cls, std::string type, std::string operation, bool value){
-	auto clsIt = this->characteristics.find(cls);
-	if (clsIt != this->characteristics.end()){
-		auto typeIt = clsIt->second.find(type);
-		if (typeIt != clsIt->second.end()){
-			typeIt->second.parseExpression(operation, value);
-		}
+	ST::SymbolTable& symbols = ST::SymbolTable::global();
+	int slot = (this->sdb == NULL) ? -1 : this->sdb->getSlot(symbols.find(cls), symbols.find(type));
+	if (slot >= 0){
+		this->parseExpression(slot, operation, value ? 1 : 0);
+	}
+}
+
+void Character::parseExpression(int slot, std::string operation, int value){
+	int opcode = ST::EXP_NONE;
+	if (operation == "+"){
+		opcode = ST::EXP_ADD;
+	}
+	else if (operation == "-"){
+		opcode = ST::EXP_SUBTRACT;
+	}
+	else if (operation == "="){
+		opcode = ST::EXP_SET;
+	}
+
+	if (opcode != ST::EXP_SET && this->sdb->getSlotInfo(slot).isBoolean){
+		std::cout << "Character::parseExpression error: the operation '" << operation
+				  << "' has to be '=' because a boolean is being parsed." << std::endl;
+		exit(-1);
+	}
+	else if (opcode == ST::EXP_NONE){
+		std::cout << "Character::parseExpression error: the operation '" << operation
+				  << "' has to be '+', '-', or '='." << std::endl;
+		exit(-1);
+	}
+	this->applyExpression(slot, opcode, value);
+}
+
+//Integer values are clamped to the SDB class's range, booleans can only be set.
+//opcode is an ST::ExpressionOpcode
+void Character::applyExpression(int slot, int opcode, int value){
+	const SDBSlot& info = this->sdb->getSlotInfo(slot);
+	int& current = this->values[slot];
+	int old = current;
+
+	if (opcode == ST::EXP_SET){
+		current = value;
+	}
+	else if (info.isBoolean){
+		std::cout << "Character::parseExpression error: the operation has to be '=' because a boolean is being parsed." << std::endl;
+		exit(-1);
+	}
+	else if (opcode == ST::EXP_ADD || opcode == ST::EXP_SUBTRACT){
+		//Either end can be crossed, since the operand may be negative
+		long long next = (opcode == ST::EXP_ADD) ? (long long)current + value : (long long)current - value;
+		current = (int)std::max<long long>(info.min, std::min<long long>(info.max, next));
+	}
+	else {
+		std::cout << "Character::parseExpression error: the operation has to be '+', '-', or '='." << std::endl;
+		exit(-1);
+	}
+
+	if (current != old){
+		this->versions[slot]++;
 	}
 }
 
@@ -51,4 +135,89 @@ void Character::addAction(int uid, const ST::Action& action){
 	else {
 		this->actionTree.addAction(uid, action);
 	}
-}
\ No newline at end of file
+}
+
+int Character::getValue(int slot) const{
+	return this->values[slot];
+}
+
+unsigned int Character::getVersion(int slot) const{
+	return this->versions[slot];
+}
+
+bool Character::isSatisfied(int action) const{
+	return this->satisfied[action];
+}
+
+void Character::setSatisfied(int action, bool satisfied){
+	this->satisfied[action] = satisfied;
+}
+
+//Marks every action unsatisfied, making room for any added since the last reset
+void Character::resetSatisfied(){
+	this->satisfied.assign(this->compiledTree.size(), false);
+}
+
+MemoryBank& Character::getMemoryBank(){
+	return this->memoryBank;
+}
+
+const MemoryBank& Character::getMemoryBank() const{
+	return this->memoryBank;
+}
+
+const ActionTree& Character::getActionTree() const{
+	return this->actionTree;
+}
+
+const ST::CompiledTree& Character::getCompiledTree() const{
+	return this->compiledTree;
+}
+
+//pruner, if there is one, has to have just pruned this character's ActionTree
+void Character::compileActionTree(const ST::ActionTreePruner* pruner){
+	this->compiledTree.compile(this->actionTree, pruner);
+	this->pruneReport = (pruner != NULL) ? pruner->getReport() : ST::PruneReport();
+}
+
+//Runs the character off a tree someone else owns, such as a mapped StoryImage's
+void Character::mapActionTree(const ST::CompiledTreeView& view){
+	this->compiledTree.map(view);
+	this->pruneReport = ST::PruneReport();
+}
+
+//Runs the character off its own copy of a StoryImage's tree whose symbol ids aren't this process's
+void Character::mapActionTree(const ST::CompiledTreeView& view, const std::vector<int>& symbolIDs){
+	this->compiledTree.map(view, symbolIDs);
+	this->pruneReport = ST::PruneReport();
+}
+
+const ST::PruneReport& Character::getPruneReport() const{
+	return this->pruneReport;
+}
+
+ST::StoryStats& Character::getStats(){
+	return this->stats;
+}
+
+//Overwrites the first count values, as a StoryImage stores them
+void Character::setValues(const int* values, unsigned int count){
+	for (unsigned int slot = 0; slot < count && slot < this->values.size(); slot++){
+		if (this->values[slot] != values[slot]){
+			this->values[slot] = values[slot];
+			this->versions[slot]++;
+		}
+	}
+}
+
+//Everything the character points to, by what it's for. The character's own sizeof is counted by the CharacterDB
+ST::CharacterMemoryUsage Character::getMemoryUsage() const{
+	ST::CharacterMemoryUsage usage;
+	usage.name = this->name;
+	usage.values = ST::stringBytes(this->name) + ST::vectorBytes(this->values) + ST::vectorBytes(this->versions) + ST::vectorBytes(this->satisfied);
+	usage.actionTree = this->actionTree.getMemoryUsage() + ST::vectorBytes(this->pruneReport.deadActions) +
+		ST::vectorBytes(this->pruneReport.deadLinks) + ST::vectorBytes(this->pruneReport.impliedPreconditions);
+	usage.compiledTree = this->compiledTree.getMemoryUsage();
+	usage.memoryBank = this->memoryBank.getMemoryUsage();
+	return usage;
+}
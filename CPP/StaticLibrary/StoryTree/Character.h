@@ -7,9 +7,15 @@
 #include "Characteristic.h"
 #include "MemoryBank.h"
 #include "ActionTree.h"
+#include "CompiledTree.h"
+#include "ActionTreePruner.h"
+#include "StoryStats.h"
+#include "MemoryReport.h"
 
 #include <string>
-#include <unordered_map>
+#include <vector>
+
+class SDB;
 
 class Character
 {
@@ -20,19 +26,60 @@ public:
 
 	std::string																					getName();
 
+	void																						bindSDB(const SDB* sdb);
+	void																						syncSlots();
+
 	void																						addCharacteristic(const ST::Characteristic& characteristic);
 	void																						parseExpression(std::string cls, std::string type, std::string operation, int value);
 	void																						parseExpression(std::string cls, std::string type, std::string operation, bool value);
+	void																						parseExpression(int slot, std::string operation, int value);
+	void																						applyExpression(int slot, int opcode, int value);
 	void																						addAction(int uid, const ST::Action& action);
 
+	int																							getValue(int slot) const;
+	unsigned int																				getVersion(int slot) const;
+	bool																						isSatisfied(int action) const;
+	void																						setSatisfied(int action, bool satisfied);
+	void																						resetSatisfied();
+	MemoryBank&																					getMemoryBank();
+	const MemoryBank&																			getMemoryBank() const;
+	const ActionTree&																			getActionTree() const;
+	const ST::CompiledTree&																		getCompiledTree() const;
+	void																						compileActionTree(const ST::ActionTreePruner* pruner = NULL);
+	const ST::PruneReport&																		getPruneReport() const;
+	ST::StoryStats&																			getStats();
+	ST::CharacterMemoryUsage																getMemoryUsage() const;
+	void																						mapActionTree(const ST::CompiledTreeView& view);
+	void																						mapActionTree(const ST::CompiledTreeView& view, const std::vector<int>& symbolIDs);
+	void																						setValues(const int* values, unsigned int count);
+
 private:
 	std::string																					name;
 
-	std::unordered_map<std::string, std::unordered_map<std::string, ST::Characteristic>>		characteristics;
+	//One value per SDB slot, booleans stored as 0 or 1. Slots this character was never
+	//given a characteristic for hold the SDB class's default value
+	const SDB*																					sdb = NULL;
+	std::vector<int>																			values;
+
+	//Bumped whenever the slot's value changes, so cached results that read it can tell
+	std::vector<unsigned int>																	versions;
 
 	MemoryBank																					memoryBank;
 
 	ActionTree																					actionTree;
+
+	//What the engine actually runs: actionTree compiled, or arrays in a mapped StoryImage
+	ST::CompiledTree																			compiledTree;
+
+	//What was left out of actionTree the last time it was compiled
+	ST::PruneReport																				pruneReport;
+
+	//What getOptions and precondition evaluation have cost this character, see ST::StoryStats
+	ST::StoryStats																				stats;
+
+	//Whether each action's preconditions currently hold, by ActionTree index. StoryTree keeps it
+	//up to date as values change
+	std::vector<bool>																			satisfied;
 };
 
 #endif
\ No newline at end of file
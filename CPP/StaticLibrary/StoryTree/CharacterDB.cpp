@@ -1,6 +1,8 @@
 //CharacterDB.cpp
 #include "stdafx.h"
 #include "CharacterDB.h"
+#include "MemoryReport.h"
+#include "SymbolTable.h"
 
 
 CharacterDB::CharacterDB()
@@ -13,14 +15,31 @@ CharacterDB::~CharacterDB()
 }
 
 void CharacterDB::addCharacter(std::string name){
-	this->characters[name] = Character(name);
+	int nameID = ST::SymbolTable::global().intern(name);
+	this->characters[nameID] = Character(name);
+
+	if (nameID >= (int)this->charactersByID.size()){
+		this->charactersByID.resize(nameID + 1, NULL);
+	}
+	this->charactersByID[nameID] = &(this->characters[nameID]);
 }
 
-Character CharacterDB::getCharacter(std::string name){
-	auto myCharIt = this->characters.find(name);
-	if (myCharIt != this->characters.end()){
-		Character myChar = myCharIt->second;
-		return myChar;
+Character* CharacterDB::getCharacter(std::string name){
+	return this->getCharacter(ST::SymbolTable::global().find(name));
+}
+
+Character* CharacterDB::getCharacter(int nameID){
+	if (nameID >= 0 && nameID < (int)this->charactersByID.size()){
+		return this->charactersByID[nameID];
+	}
+	else {
+		return NULL;
+	}
+}
+
+const Character* CharacterDB::getCharacter(int nameID) const{
+	if (nameID >= 0 && nameID < (int)this->charactersByID.size()){
+		return this->charactersByID[nameID];
 	}
 	else {
 		return NULL;
@@ -37,4 +56,16 @@ std::vector<std::string> CharacterDB::getListOfCharacters(){
 		charList.push_back(it.second.getName());
 	}
 	return charList;
-}
\ No newline at end of file
+}
+
+//Points every character at the SDB's slot layout, giving any new slots their default values
+void CharacterDB::bindSDB(const SDB* sdb){
+	for (auto& it : this->characters){
+		it.second.bindSDB(sdb);
+	}
+}
+
+//The table holding the characters, each character's own sizeof included, but not what they point to
+size_t CharacterDB::getMemoryUsage() const{
+	return ST::hashMapBytes(this->characters) + ST::vectorBytes(this->charactersByID);
+}
@@ -17,12 +17,20 @@ public:
 	~CharacterDB();
 
 	void													addCharacter(std::string name);
-	Character												getCharacter(std::string name);
+	Character*												getCharacter(std::string name);
+	Character*												getCharacter(int nameID);
+	const Character*										getCharacter(int nameID) const;
 	bool													isEmpty();
 	std::vector<std::string>								getListOfCharacters();
+	void													bindSDB(const SDB* sdb);
+	size_t													getMemoryUsage() const;
 
 private:
-	std::unordered_map<std::string, Character>				characters;
+	//Keyed by the interned character name
+	std::unordered_map<int, Character>						characters;
+
+	//characters indexed directly by name id, so the engine's lookups are a single load
+	std::vector<Character*>									charactersByID;
 };
 
 #endif
\ No newline at end of file
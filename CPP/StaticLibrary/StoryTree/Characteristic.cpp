@@ -18,19 +18,32 @@ namespace ST{
 	Characteristic::Characteristic(std::string character, std::string cls, std::string type, int value){
 		this->isBoolean = false;
 
-		this->character = character;
-		this->cls = cls;
-		this->type = type;
 		this->intValue = value;
+
+		//Without an SDB range the value is unbounded
+		this->min = INT_MIN;
+		this->max = INT_MAX;
+
+		this->internNames(character, cls, type);
+	}
+
+	Characteristic::Characteristic(std::string character, std::string cls, std::string type, int value, int min, int max){
+		this->isBoolean = false;
+
+		this->intValue = value;
+
+		this->min = min;
+		this->max = max;
+
+		this->internNames(character, cls, type);
 	}
 
 	Characteristic::Characteristic(std::string character, std::string cls, std::string type, bool value){
 		this->isBoolean = true;
 
-		this->character = character;
-		this->cls = cls;
-		this->type = type;
 		this->boolValue = value;
+
+		this->internNames(character, cls, type);
 	}
 
 	void Characteristic::parseExpression(std::string operation, int value){
@@ -64,15 +77,15 @@ namespace ST{
 
 	//Getter functions, with const overloads
 	std::string Characteristic::getClass(){
-		return (this->cls);
+		return SymbolTable::global().getName(this->clsID);
 	}
 
 	std::string Characteristic::getType(){
-		return (this->type);
+		return SymbolTable::global().getName(this->typeID);
 	}
 
 	std::string Characteristic::getCharacter(){
-		return (this->character);
+		return SymbolTable::global().getName(this->characterID);
 	}
 
 	bool Characteristic::boolean(){
@@ -83,20 +96,24 @@ namespace ST{
 		return (this->intValue);
 	}
 
+	bool Characteristic::getBoolValue(){
+		return (this->boolValue);
+	}
+
 	bool Characteristic::getBoolValue() const{
 		return (this->boolValue);
 	}
 
 	std::string Characteristic::getClass() const{
-		return (this->cls);
+		return SymbolTable::global().getName(this->clsID);
 	}
 
 	std::string Characteristic::getType() const{
-		return (this->type);
+		return SymbolTable::global().getName(this->typeID);
 	}
 
 	std::string Characteristic::getCharacter() const{
-		return (this->character);
+		return SymbolTable::global().getName(this->characterID);
 	}
 
 	bool Characteristic::boolean() const{
@@ -149,13 +166,29 @@ namespace ST{
 	}
 
 
+	int Characteristic::getCharacterID() const{
+		return (this->characterID);
+	}
+
+	int Characteristic::getClassID() const{
+		return (this->clsID);
+	}
+
+	int Characteristic::getTypeID() const{
+		return (this->typeID);
+	}
+
+
 	//private functions
+	void Characteristic::internNames(const std::string& character, const std::string& cls, const std::string& type){
+		SymbolTable& symbols = SymbolTable::global();
+		this->characterID = symbols.intern(character);
+		this->clsID = symbols.intern(cls);
+		this->typeID = symbols.intern(type);
+	}
+
 	void Characteristic::addValue(int value){
-		if (this->max == NULL){
-			std::cout << "Characteristic::parseExpression() warning: There is no assigned max value for your characteristic. " << std::endl;
-			return;
-		}
-		if (this->intValue + value > this->max){
+		if (this->intValue > this->max - value){
 			this->intValue = this->max;
 		}
 		else{
@@ -164,11 +197,7 @@ namespace ST{
 	}
 
 	void Characteristic::subValue(int value){
-		if (this->min == NULL){
-			std::cout << "Characteristic::parseExpression() warning: There is no assigned min value for your characteristic. " << std::endl;
-			return;
-		}
-		if (this->intValue + value > this->min){
+		if (this->intValue < this->min + value){
 			this->intValue = this->min;
 		}
 		else{
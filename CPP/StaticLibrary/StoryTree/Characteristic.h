@@ -4,7 +4,10 @@
 
 #include "stdafx.h"
 
+#include "SymbolTable.h"
+
 #include <string>
+#include <climits>
 
 namespace ST{
 
@@ -14,6 +17,7 @@ namespace ST{
 		Characteristic();
 		Characteristic(std::string character, std::string cls, std::string type, int value);
 		Characteristic(std::string character, std::string cls, std::string type, bool value);
+		Characteristic(std::string character, std::string cls, std::string type, int value, int min, int max);
 
 		~Characteristic();
 
@@ -38,25 +42,32 @@ namespace ST{
 		int						getMin() const;
 		int						getMax() const;
 
-	private:
-		std::string				character;
+		int						getCharacterID() const;
+		int						getClassID() const;
+		int						getTypeID() const;
 
-		std::string				cls;
-		std::string				type;
+	private:
+		//Interned ids of the character, class and type. The names only live in the SymbolTable
+		int						characterID = SymbolTable::NONE;
+		int						clsID = SymbolTable::NONE;
+		int						typeID = SymbolTable::NONE;
 		
-		int						intValue;
-		bool					boolValue;
+		int						intValue = 0;
+		bool					boolValue = false;
 
-		bool					isBoolean;
+		bool					isBoolean = false;
 
-		int						min;
-		int						max;
+		int						min = 0;
+		int						max = 0;
 
 		//private functions for use in ParseExpression
 		void					addValue(int value);
 		void					subValue(int value);
 		void					setValue(int value);
 
+		//private function for the constructors
+		void					internNames(const std::string& character, const std::string& cls, const std::string& type);
+
 	};
 
 }
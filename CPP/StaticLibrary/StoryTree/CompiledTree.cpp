@@ -0,0 +1,366 @@
+//CompiledTree.cpp
+#include "stdafx.h"
+#include "CompiledTree.h"
+#include "MemoryReport.h"
+#include "ActionTree.h"
+#include "ActionTreePruner.h"
+
+#include <algorithm>
+#include <iostream>
+#include <unordered_map>
+
+namespace ST{
+
+	CompiledTree::CompiledTree()
+	{
+		this->pointAtStorage();
+	}
+
+	CompiledTree::CompiledTree(const CompiledTree& tree)
+	{
+		*this = tree;
+	}
+
+
+	CompiledTree::~CompiledTree()
+	{
+	}
+
+	CompiledTree& CompiledTree::operator=(const CompiledTree& tree){
+		this->mapped = tree.mapped;
+		this->actions = tree.actions;
+		this->infos = tree.infos;
+		this->firsts = tree.firsts;
+		this->children = tree.children;
+		this->preconditions = tree.preconditions;
+		this->expressions = tree.expressions;
+		this->uids = tree.uids;
+		this->classCount = tree.classCount;
+		this->nameOffsets = tree.nameOffsets;
+		this->nameData = tree.nameData;
+		this->ownsArrays = tree.ownsArrays;
+
+		if (this->ownsArrays){
+			this->pointAtStorage();
+		}
+		else {
+			this->view = tree.view;
+		}
+		return *this;
+	}
+
+	//Flattens tree, laying actions out in the depth first order traversals visit them in, so walking
+	//the tree reads its arrays mostly front to back. Actions no first leads to go at the end.
+	//Children and firsts with no action are left out, with a warning, since a traversal would skip them anyway.
+	//If pruner has just pruned tree, what it took out is left out too. Dead actions are still compiled, with
+	//nothing leading to them and no children or preconditions, so executeAction and getActionName know them
+	void CompiledTree::compile(const ActionTree& tree, const ActionTreePruner* pruner){
+		this->mapped = false;
+		this->ownsArrays = true;
+		this->actions.clear();
+		this->infos.clear();
+		this->firsts.clear();
+		this->children.clear();
+		this->preconditions.clear();
+		this->expressions.clear();
+		this->uids.clear();
+		this->classCount = 0;
+		this->nameOffsets.assign(1, 0);
+		this->nameData.clear();
+
+		std::vector<int> order = this->depthFirstOrder(tree, pruner);
+
+		//position[ActionTree index] is the action's index in this tree
+		std::vector<int> position(tree.size());
+		for (unsigned int index = 0; index < order.size(); index++){
+			position[order[index]] = index;
+		}
+
+		//classIndex[class symbol id] is the class's index in this tree
+		std::unordered_map<int, int> classIndex;
+		//nameIndex[display name] is the name's index in the pool
+		std::unordered_map<std::string, int> nameIndex;
+
+		for (unsigned int index = 0; index < order.size(); index++){
+			const Action* action = tree.getActionAt(order[index]);
+
+			CompiledAction compiled;
+			compiled.clsID = SymbolTable::NONE;
+			if (action->getClassID() != SymbolTable::NONE){
+				auto found = classIndex.find(action->getClassID());
+				if (found == classIndex.end()){
+					found = classIndex.insert(std::make_pair(action->getClassID(), (int)classIndex.size())).first;
+				}
+				compiled.clsID = found->second;
+			}
+			compiled.flags = (action->isFirst() ? ACTION_FIRST : 0) | (action->isLeaf() ? ACTION_LEAF : 0);
+
+			compiled.childBegin = this->children.size();
+			const std::vector<int>& actionChildren = action->getChildren();
+			for (unsigned int i = 0; i < actionChildren.size(); i++){
+				if (pruner != NULL && !pruner->keepsChild(order[index], i)){
+					continue;
+				}
+				int child = actionChildren[i];
+				int childIndex = tree.getIndex(child);
+				if (childIndex < 0){
+					std::cout << "CompiledTree::compile() warning: There's no uid with the number " << child << std::endl;
+					continue;
+				}
+				this->children.push_back(position[childIndex]);
+			}
+			compiled.childCount = this->children.size() - compiled.childBegin;
+
+			const std::vector<PreconditionOp>& ops = action->getPreconditionProgram().getOps();
+			compiled.preBegin = this->preconditions.size();
+			for (unsigned int i = 0; i < ops.size(); i++){
+				if (pruner == NULL || pruner->keepsPrecondition(order[index], i)){
+					this->preconditions.push_back(ops[i]);
+				}
+			}
+			compiled.preCount = this->preconditions.size() - compiled.preBegin;
+
+			compiled.expBegin = this->expressions.size();
+			compiled.expCount = action->getExpressions().size();
+			for (auto& exp : action->getExpressions()){
+				this->expressions.push_back(exp.compile());
+			}
+
+			this->actions.push_back(compiled);
+
+			CompiledActionInfo info;
+			info.uid = action->getUID();
+			info.nameID = SymbolTable::NONE;
+			std::string name = action->getName();
+			if (!name.empty()){
+				auto found = nameIndex.find(name);
+				if (found == nameIndex.end()){
+					found = nameIndex.insert(std::make_pair(name, (int)nameIndex.size())).first;
+					this->nameData.insert(this->nameData.end(), name.begin(), name.end());
+					this->nameOffsets.push_back(this->nameData.size());
+				}
+				info.nameID = found->second;
+			}
+			this->infos.push_back(info);
+
+			UIDIndex uid;
+			uid.uid = info.uid;
+			uid.index = index;
+			this->uids.push_back(uid);
+		}
+
+		for (auto& first : tree.getFirsts()){
+			int firstIndex = tree.getIndex(first);
+			if (firstIndex < 0){
+				std::cout << "CompiledTree::compile() warning: There's no uid with the number " << first << std::endl;
+				continue;
+			}
+			if (pruner != NULL && !pruner->isLive(firstIndex)){
+				continue;
+			}
+			this->firsts.push_back(position[firstIndex]);
+		}
+		this->classCount = classIndex.size();
+
+		std::sort(this->uids.begin(), this->uids.end(), [](const UIDIndex& a, const UIDIndex& b){
+			return a.uid < b.uid;
+		});
+
+		this->pointAtStorage();
+	}
+
+	//Uses arrays someone else owns, such as a mapped StoryImage's, which must outlive the tree
+	void CompiledTree::map(const CompiledTreeView& view){
+		this->mapped = true;
+		this->ownsArrays = false;
+		this->actions.clear();
+		this->infos.clear();
+		this->firsts.clear();
+		this->children.clear();
+		this->preconditions.clear();
+		this->expressions.clear();
+		this->uids.clear();
+		this->classCount = 0;
+		this->nameOffsets.clear();
+		this->nameData.clear();
+		this->view = view;
+	}
+
+	//Copies a tree out of someone else's arrays, such as a StoryImage written by another process, translating
+	//the symbol ids its preconditions and expressions hold: symbolIDs[id in view] is this process's id.
+	//It still counts as mapped, since there's no ActionTree behind it to compile again
+	void CompiledTree::map(const CompiledTreeView& view, const std::vector<int>& symbolIDs){
+		this->mapped = true;
+		this->ownsArrays = true;
+		this->actions.assign(view.actions, view.actions + view.actionCount);
+		this->infos.assign(view.infos, view.infos + view.actionCount);
+		this->uids.assign(view.uids, view.uids + view.actionCount);
+		this->firsts.assign(view.firsts, view.firsts + view.firstCount);
+		this->children.assign(view.children, view.children + view.childCount);
+		this->preconditions.assign(view.preconditions, view.preconditions + view.preconditionCount);
+		this->expressions.assign(view.expressions, view.expressions + view.expressionCount);
+		this->classCount = view.classCount;
+
+		auto translate = [&symbolIDs](int& id){
+			if (id >= 0 && id < (int)symbolIDs.size()){
+				id = symbolIDs[id];
+			}
+		};
+		for (auto& pre : this->preconditions){
+			translate(pre.character);
+		}
+		for (auto& exp : this->expressions){
+			translate(exp.character);
+			translate(exp.key);
+		}
+
+		//Name offsets are into the whole image's names, so they're rebased onto this tree's copy
+		this->nameOffsets.assign(1, 0);
+		this->nameData.clear();
+		if (view.nameCount > 0){
+			for (unsigned int name = 1; name <= view.nameCount; name++){
+				this->nameOffsets.push_back(view.nameOffsets[name] - view.nameOffsets[0]);
+			}
+			this->nameData.assign(view.nameData + view.nameOffsets[0], view.nameData + view.nameOffsets[view.nameCount]);
+		}
+
+		this->pointAtStorage();
+	}
+
+	bool CompiledTree::isMapped() const{
+		return this->mapped;
+	}
+
+	unsigned int CompiledTree::size() const{
+		return this->view.actionCount;
+	}
+
+	//Returns -1 if there's no action with the uid
+	int CompiledTree::getIndex(int uid) const{
+		const UIDIndex* begin = this->view.uids;
+		const UIDIndex* end = this->view.uids + this->view.actionCount;
+		const UIDIndex* found = std::lower_bound(begin, end, uid, [](const UIDIndex& entry, int uid){
+			return entry.uid < uid;
+		});
+		if (found == end || found->uid != uid){
+			return -1;
+		}
+		return found->index;
+	}
+
+	const CompiledAction& CompiledTree::getAction(int index) const{
+		return this->view.actions[index];
+	}
+
+	int CompiledTree::getUID(int index) const{
+		return this->view.infos[index].uid;
+	}
+
+	//The display name of the action at index, or "" for an action added without one
+	std::string CompiledTree::getName(int index) const{
+		int nameID = this->view.infos[index].nameID;
+		if (nameID == SymbolTable::NONE){
+			return "";
+		}
+		return std::string(this->view.nameData + this->view.nameOffsets[nameID], this->view.nameData + this->view.nameOffsets[nameID + 1]);
+	}
+
+	const int* CompiledTree::getChildren(const CompiledAction& action) const{
+		return this->view.children + action.childBegin;
+	}
+
+	const PreconditionOp* CompiledTree::getPreconditions(const CompiledAction& action) const{
+		return this->view.preconditions + action.preBegin;
+	}
+
+	const ExpressionOp* CompiledTree::getExpressions(const CompiledAction& action) const{
+		return this->view.expressions + action.expBegin;
+	}
+
+	const int* CompiledTree::getFirsts() const{
+		return this->view.firsts;
+	}
+
+	unsigned int CompiledTree::getFirstCount() const{
+		return this->view.firstCount;
+	}
+
+	unsigned int CompiledTree::getClassCount() const{
+		return this->view.classCount;
+	}
+
+	const CompiledTreeView& CompiledTree::getView() const{
+		return this->view;
+	}
+
+	//ActionTree indices in preorder from each first in turn, children in the order they were added.
+	//An action reached from more than one parent goes where it's first reached
+	std::vector<int> CompiledTree::depthFirstOrder(const ActionTree& tree, const ActionTreePruner* pruner) const{
+		std::vector<int> order;
+		std::vector<bool> placed(tree.size(), false);
+		std::vector<int> stack;
+
+		for (auto& first : tree.getFirsts()){
+			int firstIndex = tree.getIndex(first);
+			if (firstIndex >= 0 && (pruner == NULL || pruner->isLive(firstIndex))){
+				stack.push_back(firstIndex);
+			}
+
+			while (!stack.empty()){
+				int index = stack.back();
+				stack.pop_back();
+				if (placed[index]){
+					continue;
+				}
+				placed[index] = true;
+				order.push_back(index);
+
+				//Pushed last to first, so the first child comes off the stack next
+				const std::vector<int>& children = tree.getActionAt(index)->getChildren();
+				for (int child = (int)children.size() - 1; child >= 0; child--){
+					if (pruner != NULL && !pruner->keepsChild(index, child)){
+						continue;
+					}
+					int childIndex = tree.getIndex(children[child]);
+					if (childIndex >= 0 && !placed[childIndex]){
+						stack.push_back(childIndex);
+					}
+				}
+			}
+		}
+
+		for (unsigned int index = 0; index < tree.size(); index++){
+			if (!placed[index]){
+				order.push_back(index);
+			}
+		}
+		return order;
+	}
+
+	void CompiledTree::pointAtStorage(){
+		this->view.actions = this->actions.data();
+		this->view.actionCount = this->actions.size();
+		this->view.firsts = this->firsts.data();
+		this->view.firstCount = this->firsts.size();
+		this->view.children = this->children.data();
+		this->view.childCount = this->children.size();
+		this->view.preconditions = this->preconditions.data();
+		this->view.preconditionCount = this->preconditions.size();
+		this->view.expressions = this->expressions.data();
+		this->view.expressionCount = this->expressions.size();
+		this->view.infos = this->infos.data();
+		this->view.uids = this->uids.data();
+		this->view.classCount = this->classCount;
+		this->view.nameOffsets = this->nameOffsets.data();
+		this->view.nameData = this->nameData.data();
+		this->view.nameCount = this->nameOffsets.empty() ? 0 : this->nameOffsets.size() - 1;
+	}
+
+	//Nothing for a tree mapped straight onto an image's arrays
+	size_t CompiledTree::getMemoryUsage() const{
+		return vectorBytes(this->actions) + vectorBytes(this->infos) + vectorBytes(this->firsts) + vectorBytes(this->children) +
+			vectorBytes(this->preconditions) + vectorBytes(this->expressions) + vectorBytes(this->uids) +
+			vectorBytes(this->nameOffsets) + vectorBytes(this->nameData);
+	}
+
+}
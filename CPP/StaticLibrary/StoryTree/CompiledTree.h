@@ -0,0 +1,130 @@
+//CompiledTree.h
+#ifndef CompiledTree_H
+#define CompiledTree_H
+
+#include "stdafx.h"
+
+#include "PreconditionProgram.h"
+#include "Expression.h"
+
+#include <string>
+#include <vector>
+
+class ActionTree;
+
+namespace ST{
+
+	class ActionTreePruner;
+
+	enum CompiledActionFlags{
+		ACTION_FIRST = 1,
+		ACTION_LEAF = 2
+	};
+
+	//One action of a CompiledTree, holding only what traversals read. Its children, preconditions and
+	//expressions are the ranges [childBegin, childBegin + childCount) and so on of the tree's flat
+	//arrays; children are indices. clsID numbers the tree's own classes from 0 to classCount - 1,
+	//or is SymbolTable::NONE, so marking classes off takes a bit per class the tree actually has
+	struct CompiledAction{
+		int									clsID;
+		int									flags;
+		unsigned int						childBegin;
+		unsigned int						childCount;
+		unsigned int						preBegin;
+		unsigned int						preCount;
+		unsigned int						expBegin;
+		unsigned int						expCount;
+	};
+
+	//What only the API reads about an action, kept apart so it doesn't take up cache lines traversals use.
+	//nameID indexes the tree's name pool, or is SymbolTable::NONE for an action with no name
+	struct CompiledActionInfo{
+		int									uid;
+		int									nameID;
+	};
+
+	//uids sorted ascending, for finding an action's index
+	struct UIDIndex{
+		int									uid;
+		int									index;
+	};
+
+	//Where a CompiledTree's arrays are. They're either the tree's own vectors or part of a mapped StoryImage
+	struct CompiledTreeView{
+		const CompiledAction*				actions;
+		unsigned int						actionCount;
+		const int*							firsts;
+		unsigned int						firstCount;
+		const int*							children;
+		unsigned int						childCount;
+		const PreconditionOp*				preconditions;
+		unsigned int						preconditionCount;
+		const ExpressionOp*					expressions;
+		unsigned int						expressionCount;
+		const CompiledActionInfo*			infos;
+		const UIDIndex*						uids;
+		unsigned int						classCount;
+		const unsigned int*					nameOffsets;		//nameCount + 1, into nameData
+		const char*							nameData;
+		unsigned int						nameCount;
+	};
+
+	//A character's ActionTree flattened into plain arrays, which is all getOptions and executeAction read.
+	//Actions are indexed in depth first order, and per-action state (satisfied bits, NodeStates, the
+	//dependency index) uses these indices. uids only come in through getIndex and go out in paths
+	class CompiledTree
+	{
+	public:
+		CompiledTree();
+		CompiledTree(const CompiledTree& tree);
+		~CompiledTree();
+
+		CompiledTree&						operator=(const CompiledTree& tree);
+
+		void								compile(const ActionTree& tree, const ActionTreePruner* pruner = NULL);
+		void								map(const CompiledTreeView& view);
+		void								map(const CompiledTreeView& view, const std::vector<int>& symbolIDs);
+		bool								isMapped() const;
+
+		unsigned int						size() const;
+		int									getIndex(int uid) const;
+		const CompiledAction&				getAction(int index) const;
+		int									getUID(int index) const;
+		std::string							getName(int index) const;
+		const int*							getChildren(const CompiledAction& action) const;
+		const PreconditionOp*				getPreconditions(const CompiledAction& action) const;
+		const ExpressionOp*					getExpressions(const CompiledAction& action) const;
+		const int*							getFirsts() const;
+		unsigned int						getFirstCount() const;
+		unsigned int						getClassCount() const;
+		const CompiledTreeView&				getView() const;
+		size_t								getMemoryUsage() const;
+
+	private:
+		CompiledTreeView					view;
+		bool								mapped = false;
+		bool								ownsArrays = true;
+
+		//Storage for a tree that owns its arrays, which is any but one mapped straight onto an image
+		std::vector<CompiledAction>			actions;
+		std::vector<CompiledActionInfo>		infos;
+		std::vector<int>					firsts;
+		std::vector<int>					children;
+		std::vector<PreconditionOp>			preconditions;
+		std::vector<ExpressionOp>			expressions;
+		std::vector<UIDIndex>				uids;
+		unsigned int						classCount = 0;
+
+		//The display names, each once however many actions share it. Name i is
+		//nameData[nameOffsets[i] .. nameOffsets[i + 1])
+		std::vector<unsigned int>			nameOffsets;
+		std::vector<char>					nameData;
+
+		//private functions for compile
+		std::vector<int>					depthFirstOrder(const ActionTree& tree, const ActionTreePruner* pruner) const;
+		void								pointAtStorage();
+	};
+
+}
+
+#endif
@@ -0,0 +1,62 @@
+//DependencyIndex.cpp
+#include "stdafx.h"
+#include "DependencyIndex.h"
+#include "MemoryReport.h"
+
+namespace ST{
+
+	DependencyIndex::DependencyIndex()
+	{
+	}
+
+
+	DependencyIndex::~DependencyIndex()
+	{
+	}
+
+	void DependencyIndex::clear(){
+		this->dependents.clear();
+	}
+
+	//Records that owner's action reads every slot its count precondition ops compare
+	void DependencyIndex::addAction(int owner, int action, const PreconditionOp* ops, unsigned int count){
+		ActionRef ref;
+		ref.owner = owner;
+		ref.action = action;
+
+		for (unsigned int i = 0; i < count; i++){
+			const PreconditionOp& op = ops[i];
+			std::vector<ActionRef>& refs = this->dependents[op.character][op.slot];
+
+			//An action comparing the same slot twice only needs listing once
+			if (refs.empty() || refs.back().owner != owner || refs.back().action != action){
+				refs.push_back(ref);
+			}
+		}
+	}
+
+	//Returns NULL if no precondition reads the slot
+	const std::vector<ActionRef>* DependencyIndex::getDependents(int character, int slot) const{
+		auto charIt = this->dependents.find(character);
+		if (charIt == this->dependents.end()){
+			return NULL;
+		}
+		auto slotIt = charIt->second.find(slot);
+		if (slotIt == charIt->second.end()){
+			return NULL;
+		}
+		return &(slotIt->second);
+	}
+
+	size_t DependencyIndex::getMemoryUsage() const{
+		size_t bytes = hashMapBytes(this->dependents);
+		for (auto& character : this->dependents){
+			bytes += hashMapBytes(character.second);
+			for (auto& slot : character.second){
+				bytes += vectorBytes(slot.second);
+			}
+		}
+		return bytes;
+	}
+
+}
@@ -0,0 +1,42 @@
+//DependencyIndex.h
+#ifndef DependencyIndex_H
+#define DependencyIndex_H
+
+#include "stdafx.h"
+
+#include "PreconditionProgram.h"
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+namespace ST{
+
+	//An action in some character's tree, by ActionTree index
+	struct ActionRef{
+		int									owner;
+		int									action;
+	};
+
+	//Maps every (character, slot) a precondition reads to the actions whose preconditions read it,
+	//so when a value changes only those actions need to be evaluated again
+	class DependencyIndex
+	{
+	public:
+		DependencyIndex();
+		~DependencyIndex();
+
+		void								clear();
+		void								addAction(int owner, int action, const PreconditionOp* ops, unsigned int count);
+
+		const std::vector<ActionRef>*		getDependents(int character, int slot) const;
+		size_t								getMemoryUsage() const;
+
+	private:
+		//Keyed by character id, then slot
+		std::unordered_map<int, std::unordered_map<int, std::vector<ActionRef>>>	dependents;
+	};
+
+}
+
+#endif
@@ -13,30 +13,42 @@ namespace ST{
 		//Implicit isBoolean
 		this->isBoolean = false;
 
-		this->charater = character;
-		this->cls = cls;
-		this->type = type;
-
-		if (operation != "+" && operation != "-" && operation != "="){
+		if (operation == "+"){
+			this->opcode = EXP_ADD;
+		}
+		else if (operation == "-"){
+			this->opcode = EXP_SUBTRACT;
+		}
+		else if (operation == "="){
+			this->opcode = EXP_SET;
+		}
+		else {
 			std::cout << "Expression constructor error: Your operation value of '" << operation << "' needs to be "
 					  << "either '+', '-', or '='." << std::endl;
 			exit(-1);
 		}
-		this->operation = operation;
 
 		this->intValue = value;
+
+		this->internNames(character, cls, type);
 	}
 
 	Expression::Expression(std::string character, std::string cls, std::string type, bool value){
 		//Implicit isBoolean
 		this->isBoolean = true;
-		this->operation = "=";
-
-		this->charater = character;
-		this->cls = cls;
-		this->type = type;
+		this->opcode = EXP_SET;
 
 		this->boolValue = value;
+
+		this->internNames(character, cls, type);
+	}
+
+	void Expression::internNames(const std::string& character, const std::string& cls, const std::string& type){
+		SymbolTable& symbols = SymbolTable::global();
+		this->characterID = symbols.intern(character);
+		this->clsID = symbols.intern(cls);
+		this->typeID = symbols.intern(type);
+		this->vecKeyID = symbols.intern(character + ":" + cls + ":" + type);
 	}
 
 	Expression::~Expression()
@@ -48,8 +60,7 @@ namespace ST{
 	}
 
 	std::string Expression::getVecKey(){
-		std::string key = this->charater + ":" + this->cls + ":" + this->type;
-		return key;
+		return SymbolTable::global().getName(this->vecKeyID);
 	}
 
 	bool Expression::getBoolValue(){
@@ -65,8 +76,7 @@ namespace ST{
 	}
 
 	std::string Expression::getVecKey() const{
-		std::string key = this->charater + ":" + this->cls + ":" + this->type;
-		return key;
+		return SymbolTable::global().getName(this->vecKeyID);
 	}
 
 	bool Expression::getBoolValue() const{
@@ -78,10 +88,70 @@ namespace ST{
 	}
 
 	std::string Expression::getOperation(){
-		return (this->operation);
+		return static_cast<const Expression*>(this)->getOperation();
 	}
 
 	std::string Expression::getOperation() const{
-		return (this->operation);
+		if (this->opcode == EXP_ADD){
+			return "+";
+		}
+		else if (this->opcode == EXP_SUBTRACT){
+			return "-";
+		}
+		return "=";
 	}
-}
\ No newline at end of file
+
+	std::string Expression::getCharacter() const{
+		return SymbolTable::global().getName(this->characterID);
+	}
+
+	std::string Expression::getClass() const{
+		return SymbolTable::global().getName(this->clsID);
+	}
+
+	std::string Expression::getType() const{
+		return SymbolTable::global().getName(this->typeID);
+	}
+
+	int Expression::getCharacterID() const{
+		return (this->characterID);
+	}
+
+	int Expression::getClassID() const{
+		return (this->clsID);
+	}
+
+	int Expression::getTypeID() const{
+		return (this->typeID);
+	}
+
+	int Expression::getVecKeyID() const{
+		return (this->vecKeyID);
+	}
+
+	void Expression::setSlot(int slot){
+		this->slot = slot;
+	}
+
+	int Expression::getSlot() const{
+		return (this->slot);
+	}
+
+	ExpressionOp Expression::compile() const{
+		ExpressionOp op;
+		op.character = this->characterID;
+		op.slot = this->slot;
+		op.key = this->vecKeyID;
+		op.isBoolean = this->isBoolean ? 1 : 0;
+		op.opcode = this->opcode;
+
+		if (this->isBoolean){
+			op.operand = this->boolValue ? 1 : 0;
+		}
+		else {
+			op.operand = this->intValue;
+		}
+		return op;
+	}
+
+}
@@ -4,10 +4,30 @@
 
 #include "stdafx.h"
 
+#include "SymbolTable.h"
+
 #include <string>
 
 namespace ST{
 
+	enum ExpressionOpcode{
+		EXP_NONE = 0,
+		EXP_ADD = 1,
+		EXP_SUBTRACT = 2,
+		EXP_SET = 3
+	};
+
+	//An Expression with its operation string and value reduced to ints, so applying it or working out
+	//its memory change doesn't touch a string. Boolean expressions are EXP_SET with an operand of 0 or 1
+	struct ExpressionOp{
+		int							character;
+		int							slot;
+		int							key;
+		int							opcode;
+		int							operand;
+		int							isBoolean;
+	};
+
 	class Expression
 	{
 	public:
@@ -27,17 +47,40 @@ namespace ST{
 		bool						getBoolValue() const;
 		std::string					getVecKey() const;
 		std::string					getOperation() const;
+		std::string					getCharacter() const;
+		std::string					getClass() const;
+		std::string					getType() const;
+
+		int							getCharacterID() const;
+		int							getClassID() const;
+		int							getTypeID() const;
+		int							getVecKeyID() const;
+
+		void						setSlot(int slot);
+		int							getSlot() const;
+		ExpressionOp				compile() const;
 
 	private:
-		std::string					charater;
-		std::string					cls;
-		std::string					type;
-		std::string					operation;
+		//Interned ids of the character, class, type and the "character:class:type" memory vector key.
+		//The names only live in the SymbolTable
+		int							characterID = SymbolTable::NONE;
+		int							clsID = SymbolTable::NONE;
+		int							typeID = SymbolTable::NONE;
+		int							vecKeyID = SymbolTable::NONE;
+
+		//SDB slot of cls:type, resolved when the action is added to a StoryTree
+		int							slot = -1;
+
+		//An ExpressionOpcode
+		int							opcode = EXP_NONE;
+
+		int							intValue = 0;
+		bool						boolValue = false;
 
-		int							intValue;
-		bool						boolValue;
+		bool						isBoolean = false;
 
-		bool						isBoolean;
+		//private function for the constructors
+		void						internNames(const std::string& character, const std::string& cls, const std::string& type);
 	};
 
 }
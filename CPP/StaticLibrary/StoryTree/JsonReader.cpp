@@ -0,0 +1,430 @@
+//JsonReader.cpp
+#include "stdafx.h"
+#include "JsonReader.h"
+
+#include <cstdlib>
+#include <sstream>
+
+namespace ST{
+
+	//Deeper documents are refused rather than risking the stack
+	static const unsigned int JSON_MAX_DEPTH = 256;
+
+	static const size_t JSON_BUFFER_SIZE = 1 << 16;
+
+	JsonHandler::JsonHandler()
+	{
+	}
+
+
+	JsonHandler::~JsonHandler()
+	{
+	}
+
+	const std::string& JsonHandler::getError() const{
+		return this->error;
+	}
+
+	bool JsonHandler::fail(std::string message){
+		this->error = message;
+		return false;
+	}
+
+	JsonReader::JsonReader()
+	{
+	}
+
+
+	JsonReader::~JsonReader()
+	{
+	}
+
+	bool JsonReader::parse(std::istream& input, JsonHandler& handler){
+		this->input = &input;
+		this->buffer.resize(JSON_BUFFER_SIZE);
+		this->position = 0;
+		this->available = 0;
+		this->line = 1;
+		this->column = 1;
+		this->error.clear();
+
+		//Editors on Windows like to start UTF-8 files with a byte order mark
+		if (this->peek() == 0xEF){
+			if (this->next() != 0xEF || this->next() != 0xBB || this->next() != 0xBF){
+				this->input = NULL;
+				return this->fail("The file isn't UTF-8");
+			}
+			this->column = 1;
+		}
+
+		bool parsed = this->parseValue(handler, 0);
+		if (parsed){
+			this->skipWhitespace();
+			if (this->peek() >= 0){
+				parsed = this->fail("There's more after the end of the document");
+			}
+		}
+		this->input = NULL;
+		return parsed;
+	}
+
+	const std::string& JsonReader::getError() const{
+		return this->error;
+	}
+
+	//Returns -1 at the end of the stream
+	int JsonReader::peek(){
+		if (this->position == this->available){
+			this->input->read(this->buffer.data(), this->buffer.size());
+			this->available = (size_t)this->input->gcount();
+			this->position = 0;
+			if (this->available == 0){
+				return -1;
+			}
+		}
+		return (unsigned char)this->buffer[this->position];
+	}
+
+	int JsonReader::next(){
+		int c = this->peek();
+		if (c >= 0){
+			this->position++;
+			if (c == '\n'){
+				this->line++;
+				this->column = 1;
+			}
+			else {
+				this->column++;
+			}
+		}
+		return c;
+	}
+
+	void JsonReader::skipWhitespace(){
+		int c = this->peek();
+		while (c == ' ' || c == '\t' || c == '\n' || c == '\r'){
+			this->next();
+			c = this->peek();
+		}
+	}
+
+	bool JsonReader::parseValue(JsonHandler& handler, unsigned int depth){
+		this->skipWhitespace();
+		unsigned int line = this->line;
+		unsigned int column = this->column;
+		int c = this->peek();
+
+		if (c == '{'){
+			return this->parseObject(handler, depth + 1);
+		}
+		else if (c == '['){
+			return this->parseArray(handler, depth + 1);
+		}
+		else if (c == '"'){
+			if (!this->parseString()){
+				return false;
+			}
+			this->locate(handler, line, column);
+			return this->handled(handler, handler.string(this->token));
+		}
+		else if (c == '-' || (c >= '0' && c <= '9')){
+			double value;
+			if (!this->parseNumber(value)){
+				return false;
+			}
+			this->locate(handler, line, column);
+			return this->handled(handler, handler.number(value));
+		}
+		else if (c == 't' || c == 'f'){
+			if (!this->parseLiteral((c == 't') ? "true" : "false")){
+				return false;
+			}
+			this->locate(handler, line, column);
+			return this->handled(handler, handler.boolean(c == 't'));
+		}
+		else if (c == 'n'){
+			if (!this->parseLiteral("null")){
+				return false;
+			}
+			this->locate(handler, line, column);
+			return this->handled(handler, handler.null());
+		}
+		else if (c < 0){
+			return this->fail("Expected a value but the file ended");
+		}
+		return this->fail(std::string("Expected a value but found '") + (char)c + "'");
+	}
+
+	bool JsonReader::parseObject(JsonHandler& handler, unsigned int depth){
+		if (depth > JSON_MAX_DEPTH){
+			return this->fail("The document is nested too deeply");
+		}
+		this->locate(handler, this->line, this->column);
+		this->next();
+		if (!this->handled(handler, handler.startObject())){
+			return false;
+		}
+
+		this->skipWhitespace();
+		if (this->peek() == '}'){
+			this->locate(handler, this->line, this->column);
+			this->next();
+			return this->handled(handler, handler.endObject());
+		}
+
+		while (true){
+			this->skipWhitespace();
+			unsigned int line = this->line;
+			unsigned int column = this->column;
+			if (this->peek() != '"'){
+				return this->fail("Expected a key in quotes");
+			}
+			if (!this->parseString()){
+				return false;
+			}
+			this->locate(handler, line, column);
+			if (!this->handled(handler, handler.key(this->token))){
+				return false;
+			}
+
+			this->skipWhitespace();
+			if (this->peek() != ':'){
+				return this->fail("Expected ':' after the key");
+			}
+			this->next();
+			if (!this->parseValue(handler, depth)){
+				return false;
+			}
+
+			this->skipWhitespace();
+			line = this->line;
+			column = this->column;
+			int c = this->peek();
+			if (c != ',' && c != '}'){
+				return this->fail("Expected ',' or '}' in the object");
+			}
+			this->next();
+			if (c == '}'){
+				this->locate(handler, line, column);
+				return this->handled(handler, handler.endObject());
+			}
+		}
+	}
+
+	bool JsonReader::parseArray(JsonHandler& handler, unsigned int depth){
+		if (depth > JSON_MAX_DEPTH){
+			return this->fail("The document is nested too deeply");
+		}
+		this->locate(handler, this->line, this->column);
+		this->next();
+		if (!this->handled(handler, handler.startArray())){
+			return false;
+		}
+
+		this->skipWhitespace();
+		if (this->peek() == ']'){
+			this->locate(handler, this->line, this->column);
+			this->next();
+			return this->handled(handler, handler.endArray());
+		}
+
+		while (true){
+			if (!this->parseValue(handler, depth)){
+				return false;
+			}
+
+			this->skipWhitespace();
+			unsigned int line = this->line;
+			unsigned int column = this->column;
+			int c = this->peek();
+			if (c != ',' && c != ']'){
+				return this->fail("Expected ',' or ']' in the array");
+			}
+			this->next();
+			if (c == ']'){
+				this->locate(handler, line, column);
+				return this->handled(handler, handler.endArray());
+			}
+		}
+	}
+
+	//Reads a quoted string into token, decoding escapes to UTF-8
+	bool JsonReader::parseString(){
+		this->token.clear();
+		this->next();
+
+		while (true){
+			int c = this->next();
+			if (c < 0){
+				return this->fail("The file ended inside a string");
+			}
+			else if (c == '"'){
+				return true;
+			}
+			else if (c < 0x20){
+				return this->fail("Strings can't contain control characters, escape them");
+			}
+			else if (c != '\\'){
+				this->token.push_back((char)c);
+				continue;
+			}
+
+			c = this->next();
+			switch (c){
+			case '"':	this->token.push_back('"');		break;
+			case '\\':	this->token.push_back('\\');	break;
+			case '/':	this->token.push_back('/');		break;
+			case 'b':	this->token.push_back('\b');	break;
+			case 'f':	this->token.push_back('\f');	break;
+			case 'n':	this->token.push_back('\n');	break;
+			case 'r':	this->token.push_back('\r');	break;
+			case 't':	this->token.push_back('\t');	break;
+			case 'u':{
+				unsigned int code;
+				if (!this->readHex(code)){
+					return false;
+				}
+				if (code >= 0xDC00 && code <= 0xDFFF){
+					return this->fail("A low surrogate has no high surrogate before it");
+				}
+				if (code >= 0xD800 && code <= 0xDBFF){
+					unsigned int low;
+					if (this->next() != '\\' || this->next() != 'u' || !this->readHex(low) || low < 0xDC00 || low > 0xDFFF){
+						return this->fail("A high surrogate has to be followed by a low surrogate");
+					}
+					code = 0x10000 + ((code - 0xD800) << 10) + (low - 0xDC00);
+				}
+
+				if (code < 0x80){
+					this->token.push_back((char)code);
+				}
+				else if (code < 0x800){
+					this->token.push_back((char)(0xC0 | (code >> 6)));
+					this->token.push_back((char)(0x80 | (code & 0x3F)));
+				}
+				else if (code < 0x10000){
+					this->token.push_back((char)(0xE0 | (code >> 12)));
+					this->token.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+					this->token.push_back((char)(0x80 | (code & 0x3F)));
+				}
+				else {
+					this->token.push_back((char)(0xF0 | (code >> 18)));
+					this->token.push_back((char)(0x80 | ((code >> 12) & 0x3F)));
+					this->token.push_back((char)(0x80 | ((code >> 6) & 0x3F)));
+					this->token.push_back((char)(0x80 | (code & 0x3F)));
+				}
+				break;
+			}
+			default:
+				return this->fail("Unknown escape in string");
+			}
+		}
+	}
+
+	//Checks the number against JSON's grammar while copying it into token
+	bool JsonReader::parseNumber(double& value){
+		this->token.clear();
+		if (this->peek() == '-'){
+			this->token.push_back((char)this->next());
+		}
+
+		int c = this->peek();
+		if (c == '0'){
+			this->token.push_back((char)this->next());
+		}
+		else if (c >= '1' && c <= '9'){
+			while (c >= '0' && c <= '9'){
+				this->token.push_back((char)this->next());
+				c = this->peek();
+			}
+		}
+		else {
+			return this->fail("Expected a digit in the number");
+		}
+
+		if (this->peek() == '.'){
+			this->token.push_back((char)this->next());
+			c = this->peek();
+			if (c < '0' || c > '9'){
+				return this->fail("Expected a digit after the decimal point");
+			}
+			while (c >= '0' && c <= '9'){
+				this->token.push_back((char)this->next());
+				c = this->peek();
+			}
+		}
+
+		c = this->peek();
+		if (c == 'e' || c == 'E'){
+			this->token.push_back((char)this->next());
+			c = this->peek();
+			if (c == '+' || c == '-'){
+				this->token.push_back((char)this->next());
+				c = this->peek();
+			}
+			if (c < '0' || c > '9'){
+				return this->fail("Expected a digit in the exponent");
+			}
+			while (c >= '0' && c <= '9'){
+				this->token.push_back((char)this->next());
+				c = this->peek();
+			}
+		}
+
+		value = strtod(this->token.c_str(), NULL);
+		return true;
+	}
+
+	bool JsonReader::parseLiteral(const char* literal){
+		for (const char* c = literal; *c != '\0'; c++){
+			if (this->next() != *c){
+				return this->fail(std::string("Expected ") + literal);
+			}
+		}
+		return true;
+	}
+
+	bool JsonReader::readHex(unsigned int& value){
+		value = 0;
+		for (int i = 0; i < 4; i++){
+			int c = this->next();
+			value <<= 4;
+			if (c >= '0' && c <= '9'){
+				value |= c - '0';
+			}
+			else if (c >= 'a' && c <= 'f'){
+				value |= c - 'a' + 10;
+			}
+			else if (c >= 'A' && c <= 'F'){
+				value |= c - 'A' + 10;
+			}
+			else {
+				return this->fail("Expected 4 hex digits after \\u");
+			}
+		}
+		return true;
+	}
+
+	//Tells handler where the token it's about to get starts
+	void JsonReader::locate(JsonHandler& handler, unsigned int line, unsigned int column){
+		handler.line = line;
+		handler.column = column;
+	}
+
+	bool JsonReader::handled(JsonHandler& handler, bool result){
+		if (!result){
+			std::ostringstream message;
+			message << "line " << handler.line << ", column " << handler.column << ": " << handler.getError();
+			this->error = message.str();
+		}
+		return result;
+	}
+
+	bool JsonReader::fail(std::string message){
+		std::ostringstream located;
+		located << "line " << this->line << ", column " << this->column << ": " << message;
+		this->error = located.str();
+		return false;
+	}
+
+}
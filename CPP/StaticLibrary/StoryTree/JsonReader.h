@@ -0,0 +1,89 @@
+//JsonReader.h
+#ifndef JsonReader_H
+#define JsonReader_H
+
+#include "stdafx.h"
+
+#include <istream>
+#include <string>
+#include <vector>
+
+namespace ST{
+
+	//Receives a JSON document as a sequence of events. Returning false from any of them stops the
+	//parse; call fail() to say why
+	class JsonHandler
+	{
+	public:
+		JsonHandler();
+		virtual ~JsonHandler();
+
+		virtual bool						startObject() = 0;
+		virtual bool						endObject() = 0;
+		virtual bool						startArray() = 0;
+		virtual bool						endArray() = 0;
+		virtual bool						key(const std::string& name) = 0;
+		virtual bool						string(const std::string& value) = 0;
+		virtual bool						number(double value) = 0;
+		virtual bool						boolean(bool value) = 0;
+		virtual bool						null() = 0;
+
+		const std::string&					getError() const;
+
+	protected:
+		//Where the token being handled starts, 1 based
+		unsigned int						line = 0;
+		unsigned int						column = 0;
+
+		bool								fail(std::string message);
+
+	private:
+		std::string							error;
+
+		friend class JsonReader;
+	};
+
+	//Parses JSON straight from a stream into a JsonHandler's events, a buffer at a time, without
+	//building a document
+	class JsonReader
+	{
+	public:
+		JsonReader();
+		~JsonReader();
+
+		bool								parse(std::istream& input, JsonHandler& handler);
+
+		//"line 3, column 14: <what went wrong>", from the reader or the handler
+		const std::string&					getError() const;
+
+	private:
+		std::istream*						input = NULL;
+		std::vector<char>					buffer;
+		size_t								position = 0;
+		size_t								available = 0;
+		unsigned int						line = 1;
+		unsigned int						column = 1;
+		std::string							error;
+
+		//Reused for every string and number, so tokens don't allocate once it has grown
+		std::string							token;
+
+		//private functions for parse
+		int									peek();
+		int									next();
+		void								skipWhitespace();
+		bool								parseValue(JsonHandler& handler, unsigned int depth);
+		bool								parseObject(JsonHandler& handler, unsigned int depth);
+		bool								parseArray(JsonHandler& handler, unsigned int depth);
+		bool								parseString();
+		bool								parseNumber(double& value);
+		bool								parseLiteral(const char* literal);
+		bool								readHex(unsigned int& value);
+		void								locate(JsonHandler& handler, unsigned int line, unsigned int column);
+		bool								handled(JsonHandler& handler, bool result);
+		bool								fail(std::string message);
+	};
+
+}
+
+#endif
@@ -0,0 +1,117 @@
+//MappedFile.cpp
+#include "stdafx.h"
+#include "MappedFile.h"
+
+#include <iostream>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace ST{
+
+	MappedFile::MappedFile()
+	{
+	}
+
+
+	MappedFile::~MappedFile()
+	{
+		this->close();
+	}
+
+	bool MappedFile::open(std::string path){
+		this->close();
+
+#ifdef _WIN32
+		HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+		if (file == INVALID_HANDLE_VALUE){
+			std::cout << "MappedFile::open() error: Couldn't open " << path << std::endl;
+			return false;
+		}
+		this->fileHandle = file;
+
+		LARGE_INTEGER fileSize;
+		if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0){
+			std::cout << "MappedFile::open() error: " << path << " is empty" << std::endl;
+			this->close();
+			return false;
+		}
+		this->size = fileSize.QuadPart;
+
+		HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+		if (mapping == NULL){
+			std::cout << "MappedFile::open() error: Couldn't map " << path << std::endl;
+			this->close();
+			return false;
+		}
+		this->mappingHandle = mapping;
+
+		this->data = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+#else
+		this->descriptor = ::open(path.c_str(), O_RDONLY);
+		if (this->descriptor < 0){
+			std::cout << "MappedFile::open() error: Couldn't open " << path << std::endl;
+			return false;
+		}
+
+		struct stat info;
+		if (fstat(this->descriptor, &info) != 0 || info.st_size == 0){
+			std::cout << "MappedFile::open() error: " << path << " is empty" << std::endl;
+			this->close();
+			return false;
+		}
+		this->size = info.st_size;
+
+		void* mapped = mmap(NULL, this->size, PROT_READ, MAP_SHARED, this->descriptor, 0);
+		this->data = (mapped == MAP_FAILED) ? NULL : (const unsigned char*)mapped;
+#endif
+
+		if (this->data == NULL){
+			std::cout << "MappedFile::open() error: Couldn't map " << path << std::endl;
+			this->close();
+			return false;
+		}
+		return true;
+	}
+
+	void MappedFile::close(){
+#ifdef _WIN32
+		if (this->data != NULL){
+			UnmapViewOfFile(this->data);
+		}
+		if (this->mappingHandle != NULL){
+			CloseHandle(this->mappingHandle);
+		}
+		if (this->fileHandle != NULL){
+			CloseHandle(this->fileHandle);
+		}
+#else
+		if (this->data != NULL){
+			munmap((void*)this->data, this->size);
+		}
+		if (this->descriptor >= 0){
+			::close(this->descriptor);
+		}
+#endif
+		this->data = NULL;
+		this->size = 0;
+		this->fileHandle = NULL;
+		this->mappingHandle = NULL;
+		this->descriptor = -1;
+	}
+
+	const unsigned char* MappedFile::getData() const{
+		return this->data;
+	}
+
+	unsigned long long MappedFile::getSize() const{
+		return this->size;
+	}
+
+}
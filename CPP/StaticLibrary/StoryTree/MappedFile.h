@@ -0,0 +1,40 @@
+//MappedFile.h
+#ifndef MappedFile_H
+#define MappedFile_H
+
+#include "stdafx.h"
+
+#include <string>
+
+namespace ST{
+
+	//A whole file mapped read-only into memory. Processes mapping the same file share its pages
+	class MappedFile
+	{
+	public:
+		MappedFile();
+		~MappedFile();
+
+		bool								open(std::string path);
+		void								close();
+
+		const unsigned char*				getData() const;
+		unsigned long long					getSize() const;
+
+	private:
+		const unsigned char*				data = NULL;
+		unsigned long long					size = 0;
+
+		//Windows keeps a file and a mapping handle, everything else a file descriptor
+		void*								fileHandle = NULL;
+		void*								mappingHandle = NULL;
+		int									descriptor = -1;
+
+		//Copying would unmap the file twice
+		MappedFile(const MappedFile&);
+		MappedFile&							operator=(const MappedFile&);
+	};
+
+}
+
+#endif
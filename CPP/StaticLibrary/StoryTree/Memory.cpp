@@ -1,7 +1,10 @@
 //Memory.cpp
 #include "stdafx.h"
 #include "Memory.h"
+#include "MemoryReport.h"
 
+#include <algorithm>
+#include <cstdlib>
 
 Memory::Memory()
 {
@@ -9,11 +12,19 @@ Memory::Memory()
 
 Memory::Memory(const Memory& mem)
 {
-	this->encodeActions(mem.getActionPath());
+	this->keys = mem.keys;
+	this->values = mem.values;
+	this->actionPath = mem.actionPath;
+	this->dimensionalLength = mem.dimensionalLength;
+}
 
-	for (auto& keyIt : mem.getMemVec() ){
-		this->encodeVecValue(keyIt.first, keyIt.second);
-	}
+//Assigning into a Memory reuses its buffers, which traversals rely on to copy frames without allocating
+Memory& Memory::operator=(const Memory& mem){
+	this->keys = mem.keys;
+	this->values = mem.values;
+	this->actionPath = mem.actionPath;
+	this->dimensionalLength = mem.dimensionalLength;
+	return *this;
 }
 
 Memory::~Memory()
@@ -23,58 +34,106 @@ Memory::~Memory()
 
 
 void Memory::encodeVecValue(const ST::Expression& expression, const ST::Characteristic& characteristic){
-	std::string key = expression.getVecKey();
+	SDBSlot slot;
+	slot.clsID = characteristic.getClassID();
+	slot.typeID = characteristic.getTypeID();
+	slot.isBoolean = characteristic.boolean();
+	slot.defaultVal = 0;
+	if (characteristic.boolean()){
+		slot.min = 0;
+		slot.max = 1;
+		this->encodeVecValue(expression, characteristic.getBoolValue() ? 1 : 0, slot);
+	}
+	else {
+		slot.min = characteristic.getMin();
+		slot.max = characteristic.getMax();
+		this->encodeVecValue(expression, characteristic.getIntValue(), slot);
+	}
+}
 
-	float val = 0;
-	if (this->memVec.find(key) != this->memVec.end()){
-		val = this->memVec.find(key)->second;
+//value is the current value of the expression's characteristic, slot describes its SDB class
+void Memory::encodeVecValue(const ST::Expression& expression, int value, const SDBSlot& slot){
+	float change;
+	if (Memory::getChange(expression, value, slot, change)){
+		this->addVecValue(expression.getVecKeyID(), change);
 	}
+}
 
+//How much encoding expression adds to its key, given the characteristic's current value.
+//Returns false when the expression wouldn't touch the memory at all. The change only depends on
+//the character's state, never on the memory, so one traversal can work it out once per action
+bool Memory::getChange(const ST::Expression& expression, int value, const SDBSlot& slot, float& change){
+	return Memory::getChange(expression.compile(), value, slot, change);
+}
+
+bool Memory::getChange(const ST::ExpressionOp& expression, int value, const SDBSlot& slot, float& change){
 	//The spaghetti is real
-	if (characteristic.boolean()){
-		if (expression.getBoolValue() == characteristic.getBoolValue()){
-			return;
+	if (slot.isBoolean){
+		bool boolValue = expression.isBoolean && expression.operand != 0;
+		if (boolValue == (value != 0)){
+			return false;
 		}
 		else {
-			val += 1;
+			change = 1;
 		}
 	}
 	else{
-		int oldval = characteristic.getIntValue();
-		int changeval = expression.getIntValue();
-		int actualChange = 0;
-		if (expression.getOperation() == "+"){
-			if (oldval + changeval > characteristic.getMax()){
-				actualChange = characteristic.getMax() - oldval;
-			}
-			else {
-				actualChange = changeval;
-			}
+		int oldval = value;
+		int changeval = expression.isBoolean ? 0 : expression.operand;
+		long long actualChange = 0;
+		//'+' and '-' clamp to the class's range at both ends, like Character::applyExpression
+		if (expression.opcode == ST::EXP_ADD){
+			long long next = std::max<long long>(slot.min, std::min<long long>(slot.max, (long long)oldval + changeval));
+			actualChange = next - oldval;
 		}
-		else if (expression.getOperation() == "-"){
-			if (oldval - changeval < characteristic.getMin()){
-				actualChange = oldval - characteristic.getMin();
-			}
-			else {
-				actualChange = changeval;
-			}
+		else if (expression.opcode == ST::EXP_SUBTRACT){
+			long long next = std::max<long long>(slot.min, std::min<long long>(slot.max, (long long)oldval - changeval));
+			actualChange = oldval - next;
 		}
-		else if (expression.getOperation() == "="){
-			actualChange = std::abs(oldval - changeval);
+		else if (expression.opcode == ST::EXP_SET){
+			actualChange = std::abs((long long)oldval - changeval);
 		}
 
-		float percentChange = actualChange / (characteristic.getMax() - characteristic.getMin());
+		change = (float)actualChange / (slot.max - slot.min);
+	}
+	return true;
+}
 
-		val += percentChange;
+void Memory::encodeVecValue(int key, float value){
+	unsigned int i = this->findKey(key);
+	if (i < this->keys.size() && this->keys[i] == key){
+		this->dimensionalLength += value * value - this->values[i] * this->values[i];
+		this->values[i] = value;
+		return;
 	}
 
-	this->memVec[key] = val;
+	this->keys.insert(this->keys.begin() + i, key);
+	this->values.insert(this->values.begin() + i, value);
+	this->dimensionalLength += value * value;
+}
+
+//Adds change to key's value, which starts at 0
+void Memory::addVecValue(int key, float change){
+	unsigned int i = this->findKey(key);
+	if (i < this->keys.size() && this->keys[i] == key){
+		float value = this->values[i] + change;
+		this->dimensionalLength += value * value - this->values[i] * this->values[i];
+		this->values[i] = value;
+		return;
+	}
 
-	this->dimensionalLength += val * val;
+	this->keys.insert(this->keys.begin() + i, key);
+	this->values.insert(this->values.begin() + i, change);
+	this->dimensionalLength += change * change;
 }
 
-void Memory::encodeVecValue(std::string key, float value){
-	this->memVec[key] = value;
+//Returns 0 for keys the memory doesn't have
+float Memory::getVecValue(int key) const{
+	unsigned int i = this->findKey(key);
+	if (i < this->keys.size() && this->keys[i] == key){
+		return this->values[i];
+	}
+	return 0;
 }
 
 void Memory::encodeActions(std::vector<int> actions){
@@ -93,72 +152,197 @@ void Memory::encodeActions(std::string actions){
 	this->actionPath = actions;
 }
 
+//Empties the memory but keeps its storage, so a scratch Memory can be reused
+void Memory::clear(){
+	this->keys.clear();
+	this->values.clear();
+	this->actionPath.clear();
+	this->dimensionalLength = 0;
+}
 
 Memory Memory::Normalize(){
-	Memory* newMem = new Memory();
-	(*newMem).encodeActions(this->actionPath);
-
-	float length = this->getLength();
+	Memory newMem;
+	newMem.encodeActions(this->actionPath);
+	newMem.keys = this->keys;
+	newMem.values = this->values;
+
+	//Four partial sums keep the loop free of a serial dependency, so it vectorises
+	const float* vals = this->values.data();
+	unsigned int count = this->values.size();
+	float sums[4] = { 0, 0, 0, 0 };
+	unsigned int i = 0;
+	for (; i + 4 <= count; i += 4){
+		sums[0] += vals[i] * vals[i];
+		sums[1] += vals[i + 1] * vals[i + 1];
+		sums[2] += vals[i + 2] * vals[i + 2];
+		sums[3] += vals[i + 3] * vals[i + 3];
+	}
+	for (; i < count; i++){
+		sums[0] += vals[i] * vals[i];
+	}
+	float length = std::sqrt((sums[0] + sums[1]) + (sums[2] + sums[3]));
 
-	for (auto& it : this->memVec){
-		float normVal = it.second / length;
-		(*newMem).encodeVecValue(it.first, normVal);
+	float* normVals = newMem.values.data();
+	for (i = 0; i < count; i++){
+		normVals[i] /= length;
 	}
+	newMem.dimensionalLength = 1;
 
-	return (*newMem);
+	return newMem;
 }
 
+//Merge join over the two sorted key lists
 float Memory::dot(const Memory& mem){
-	const Memory* shorter;
-	const Memory* longer;
+	float dotProduct = 0;
 
-	if (this->memVec.size() > mem.getMemVec().size()){
-		shorter = this;
-		longer = &mem;
-	}
-	else {
-		shorter = &mem;
-		longer = this;
+	unsigned int i = 0;
+	unsigned int j = 0;
+	while (i < this->keys.size() && j < mem.keys.size()){
+		if (this->keys[i] < mem.keys[j]){
+			i++;
+		}
+		else if (this->keys[i] > mem.keys[j]){
+			j++;
+		}
+		else {
+			dotProduct += this->values[i] * mem.values[j];
+			i++;
+			j++;
+		}
 	}
 
-	float dotProduct = 0;
-	auto longVec = longer->getMemVec();
-	for (auto& it: shorter->getMemVec()){
-		float sVal = it.second;
+	return dotProduct;
+}
 
-		float lVal = 0;
-		if (longVec.find(it.first) != longVec.end()){
-			lVal = longVec.find(it.first)->second;
+//timeStep weights the values of mem2, the same way MemoryBank weights newer memories
+Memory Memory::combine(const Memory& mem1, const Memory& mem2, int timeStep){
+	Memory newMem;
+	newMem.keys.reserve(mem1.keys.size() + mem2.keys.size());
+	newMem.values.reserve(mem1.keys.size() + mem2.keys.size());
+
+	float weight = 0.1f * timeStep;
+	unsigned int i = 0;
+	unsigned int j = 0;
+	while (i < mem1.keys.size() || j < mem2.keys.size()){
+		float val;
+		if (j == mem2.keys.size() || (i < mem1.keys.size() && mem1.keys[i] < mem2.keys[j])){
+			newMem.keys.push_back(mem1.keys[i]);
+			val = mem1.values[i];
+			i++;
+		}
+		else if (i == mem1.keys.size() || mem2.keys[j] < mem1.keys[i]){
+			newMem.keys.push_back(mem2.keys[j]);
+			val = mem2.values[j] + weight;
+			j++;
+		}
+		else {
+			newMem.keys.push_back(mem1.keys[i]);
+			val = mem1.values[i] + (mem2.values[j] + weight);
+			i++;
+			j++;
 		}
+		newMem.values.push_back(val);
+		newMem.dimensionalLength += val * val;
+	}
+
+	return newMem;
+}
 
-		dotProduct += sVal * lVal;
+//Equal to combine(total, candidate, timeStep).Normalize().dot(total.Normalize()) without building either
+//Memory. Only the candidate's keys change the combined vector, so with the total's sum of squares
+//(totalSquared, which the MemoryBank keeps) both the dot and the combined length come from one pass
+//over the candidate
+float Memory::combinedDot(const Memory& total, float totalSquared, const Memory& candidate, int timeStep){
+	if (total.keys.empty() || totalSquared <= 0){
+		return 0;
 	}
 
-	return dotProduct;
+	float weight = 0.1f * timeStep;
+	float dotProduct = totalSquared;
+	float combinedSquared = totalSquared;
+
+	//Both key lists are sorted, so the search for each candidate key starts where the last one ended
+	auto totalIt = total.keys.begin();
+	for (unsigned int i = 0; i < candidate.keys.size(); i++){
+		totalIt = std::lower_bound(totalIt, total.keys.end(), candidate.keys[i]);
+		float totalVal = 0;
+		if (totalIt != total.keys.end() && *totalIt == candidate.keys[i]){
+			totalVal = total.values[totalIt - total.keys.begin()];
+		}
 
-}
+		float added = candidate.values[i] + weight;
+		float combinedVal = totalVal + added;
+		dotProduct += added * totalVal;
+		combinedSquared += combinedVal * combinedVal - totalVal * totalVal;
+	}
 
-Memory Memory::combine(const Memory& mem1, const Memory& mem2){
-	Memory* newMem = new Memory();
-	for (auto& it : mem1.getMemVec()){
-		(*newMem).encodeVecValue(it.first, it.second);
+	float lengths = std::sqrt(combinedSquared) * std::sqrt(totalSquared);
+	if (lengths <= 0){
+		return 0;
 	}
+	return dotProduct / lengths;
+}
 
-	for (auto& it2 : mem2.getMemVec()){
-		auto otherIt = mem1.getMemVec().find(it2.first);
-		if ( otherIt != mem1.getMemVec().end()){
-			(*newMem).encodeVecValue(it2.first, otherIt->second + it2.second);
+//Adds mem's values plus weight into this memory and returns how much the sum of squares grew by.
+//Existing keys are updated in place; only when mem brings new keys are the vectors merged, once
+double Memory::accumulate(const Memory& mem, float weight){
+	double squaredChange = 0;
+	bool hasNewKeys = false;
+
+	auto thisIt = this->keys.begin();
+	for (unsigned int i = 0; i < mem.keys.size(); i++){
+		thisIt = std::lower_bound(thisIt, this->keys.end(), mem.keys[i]);
+		if (thisIt == this->keys.end() || *thisIt != mem.keys[i]){
+			hasNewKeys = true;
+			continue;
 		}
-		else {
-			(*newMem).encodeVecValue(it2.first, it2.second);
+		float& val = this->values[thisIt - this->keys.begin()];
+		float newVal = val + (mem.values[i] + weight);
+		squaredChange += (double)newVal * newVal - (double)val * val;
+		val = newVal;
+	}
+
+	if (hasNewKeys){
+		std::vector<int> mergedKeys;
+		std::vector<float> mergedValues;
+		mergedKeys.reserve(this->keys.size() + mem.keys.size());
+		mergedValues.reserve(this->keys.size() + mem.keys.size());
+
+		unsigned int i = 0;
+		unsigned int j = 0;
+		while (i < this->keys.size() || j < mem.keys.size()){
+			if (j == mem.keys.size() || (i < this->keys.size() && this->keys[i] <= mem.keys[j])){
+				//Keys already present were updated above
+				if (j < mem.keys.size() && this->keys[i] == mem.keys[j]){
+					j++;
+				}
+				mergedKeys.push_back(this->keys[i]);
+				mergedValues.push_back(this->values[i]);
+				i++;
+			}
+			else {
+				float newVal = mem.values[j] + weight;
+				squaredChange += (double)newVal * newVal;
+				mergedKeys.push_back(mem.keys[j]);
+				mergedValues.push_back(newVal);
+				j++;
+			}
 		}
+
+		this->keys.swap(mergedKeys);
+		this->values.swap(mergedValues);
 	}
 
-	return (*newMem);
+	this->dimensionalLength += (float)squaredChange;
+	return squaredChange;
+}
+
+const std::vector<int>& Memory::getKeys() const{
+	return this->keys;
 }
 
-std::map<std::string, float> Memory::getMemVec(){
-	return (this->memVec);
+const std::vector<float>& Memory::getValues() const{
+	return this->values;
 }
 
 std::string Memory::getActionPath(){
@@ -169,14 +353,18 @@ float Memory::getLength(){
 	return std::sqrt(this->dimensionalLength);
 }
 
-std::map<std::string, float> Memory::getMemVec() const{
-	return (this->memVec);
-}
-
 std::string Memory::getActionPath() const{
 	return (this->actionPath);
 }
 
 float Memory::getLength() const{
 	return std::sqrt(this->dimensionalLength);
-}
\ No newline at end of file
+}
+
+unsigned int Memory::findKey(int key) const{
+	return std::lower_bound(this->keys.begin(), this->keys.end(), key) - this->keys.begin();
+}
+
+size_t Memory::getMemoryUsage() const{
+	return ST::vectorBytes(this->keys) + ST::vectorBytes(this->values) + ST::stringBytes(this->actionPath);
+}
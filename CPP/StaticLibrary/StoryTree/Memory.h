@@ -6,8 +6,8 @@
 
 #include "Characteristic.h"
 #include "Expression.h"
+#include "SDB.h"
 
-#include <map>
 #include <string>
 #include <vector>
 #include <math.h>
@@ -21,26 +21,45 @@ public:
 	Memory(const Memory& mem);
 	~Memory();
 
+	Memory&											operator=(const Memory& mem);
+
 	void											encodeVecValue(const ST::Expression& expression, const ST::Characteristic& characteristic);
-	void											encodeVecValue(std::string key, float value);
+	void											encodeVecValue(const ST::Expression& expression, int value, const SDBSlot& slot);
+	void											encodeVecValue(int key, float value);
+	void											addVecValue(int key, float change);
+	static bool										getChange(const ST::Expression& expression, int value, const SDBSlot& slot, float& change);
+	static bool										getChange(const ST::ExpressionOp& expression, int value, const SDBSlot& slot, float& change);
+	float											getVecValue(int key) const;
 	void											encodeActions(std::vector<int> actions);
 	void											encodeActions(std::string actions);
+	void											clear();
 	Memory											Normalize();
 	float											dot(const Memory& mem);
-	static Memory									combine(const Memory& mem1, const Memory& mem2);
+	static Memory									combine(const Memory& mem1, const Memory& mem2, int timeStep);
+	static float									combinedDot(const Memory& total, float totalSquared, const Memory& candidate, int timeStep);
+	double											accumulate(const Memory& mem, float weight);
 
-	std::map<std::string, float>					getMemVec();
+	const std::vector<int>&							getKeys() const;
+	const std::vector<float>&						getValues() const;
 	std::string										getActionPath();
 	float											getLength();
-	std::map<std::string, float>					getMemVec() const;
 	std::string										getActionPath() const;
 	float											getLength() const;
+	size_t											getMemoryUsage() const;
 
 private:
-	std::map<std::string, float>					memVec;
+	//A sparse vector keyed by the interned "character:class:type" id of the expression that
+	//made the change. keys is kept sorted and values[i] belongs to keys[i], so dot and combine
+	//are merge joins and the float loops run over contiguous memory
+	std::vector<int>								keys;
+	std::vector<float>								values;
 	std::string										actionPath;
 
-	float											dimensionalLength;
+	//Sum of the squared values
+	float											dimensionalLength = 0;
+
+	//private function, returns the position key is or would be stored at
+	unsigned int									findKey(int key) const;
 };
 
 #endif
\ No newline at end of file
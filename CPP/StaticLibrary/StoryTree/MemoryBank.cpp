@@ -1,6 +1,12 @@
 //MemoryBank.cpp
 #include "stdafx.h"
 #include "MemoryBank.h"
+#include "MemoryReport.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <math.h>
 
 
 MemoryBank::MemoryBank()
@@ -13,25 +19,203 @@ MemoryBank::~MemoryBank()
 }
 
 void MemoryBank::addMemory(const Memory& memory){
-	this->memories.push_back(memory);
 	this->timeStep++;
-	this->refreshVec();
+	this->version++;
+	this->refreshVec(memory);
+
+	if (this->maxMemories == 0 || this->memories.size() < this->maxMemories){
+		this->memories.push_back(memory);
+	}
+	else {
+		this->spill(this->memories[this->oldest]);
+		this->memories[this->oldest] = memory;
+		this->oldest = (this->oldest + 1) % this->maxMemories;
+	}
 }
 
-void MemoryBank::refreshVec(){
-	Memory memory = this->memories.back();
+//Puts the bank back to a state saved from another, as far as scoring goes. The memories themselves
+//aren't kept, so the bank starts again with none held
+void MemoryBank::restore(int timeStep, const Memory& totalMemVec, double squaredLength){
+	this->timeStep = timeStep;
+	this->version++;
+	this->memories.clear();
+	this->oldest = 0;
+	this->totalMemVec = totalMemVec;
+	this->squaredLength = squaredLength;
+	this->inverseLength = (squaredLength > 0) ? (float)(1 / std::sqrt(squaredLength)) : 0;
+}
+
+//Keeps at most maxMemories memories (0 keeps them all), spilling the oldest to spillPath if it isn't empty.
+//Lowering the limit evicts the excess straight away. A new spillPath is emptied first, since keys from
+//an earlier run are another process's SymbolTable ids. Whatever was spilled so far is written out
+void MemoryBank::setRetention(unsigned int maxMemories, std::string spillPath){
+	if (this->spillFile != NULL){
+		this->spillFile->flush();
+	}
+	if (spillPath != this->spillPath || (this->spillFile == NULL && !spillPath.empty())){
+		this->spillPath = spillPath;
+		this->spillFile.reset();
+		if (!spillPath.empty()){
+			this->spillFile = std::make_shared<std::ofstream>(spillPath, std::ios::binary | std::ios::trunc);
+			if (!*(this->spillFile)){
+				std::cout << "MemoryBank::setRetention() error: Couldn't open " << spillPath << std::endl;
+				this->spillFile.reset();
+			}
+		}
+	}
+
+	//Put the memories back in order, oldest first, so the ring can start again at 0
+	std::rotate(this->memories.begin(), this->memories.begin() + this->oldest, this->memories.end());
+	this->oldest = 0;
 
-	for (auto& it: memory.getMemVec()){
-		float newVal = 0;
-		auto totalIt = this->totalMemVec.getMemVec().find(it.first);
-		if (totalIt != this->totalMemVec.getMemVec().end()){
-			newVal = totalIt->second;
+	if (maxMemories != 0 && this->memories.size() > maxMemories){
+		unsigned int excess = this->memories.size() - maxMemories;
+		for (unsigned int i = 0; i < excess; i++){
+			this->spill(this->memories[i]);
 		}
+		this->memories.erase(this->memories.begin(), this->memories.begin() + excess);
+	}
+	this->maxMemories = maxMemories;
+}
+
+unsigned int MemoryBank::getMemoryCount() const{
+	return this->memories.size();
+}
 
-		float weight = 0.1 * (this->timeStep - 1);
+//index 0 is the oldest memory still held. Returns NULL if there's no memory at index
+const Memory* MemoryBank::getMemory(unsigned int index) const{
+	if (index >= this->memories.size()){
+		std::cout << "MemoryBank::getMemory() error: There's no memory at index " << index << std::endl;
+		return NULL;
+	}
+	return &(this->memories[(this->oldest + index) % this->memories.size()]);
+}
+
+int MemoryBank::getSpilledCount() const{
+	return this->spilledCount;
+}
+
+//Reads back every memory spilled to spillPath, oldest first. A bank still spilling to it may not have
+//written out its latest memories until its next setRetention. Counts are checked against what's left of the file before
+//anything is allocated for them, so a corrupt file can't ask for more than it holds
+std::vector<Memory> MemoryBank::readSpill(std::string spillPath){
+	std::vector<Memory> spilled;
+	std::ifstream in(spillPath, std::ios::binary | std::ios::ate);
+	if (!in){
+		std::cout << "MemoryBank::readSpill() error: Couldn't open " << spillPath << std::endl;
+		return spilled;
+	}
+	long long size = in.tellg();
+	in.seekg(0);
+
+	int keyCount;
+	while (in.read((char*)&keyCount, sizeof(int))){
+		long long left = size - (long long)in.tellg();
+		if (keyCount < 0 || keyCount > left / (long long)(sizeof(int) + sizeof(float))){
+			std::cout << "MemoryBank::readSpill() error: " << spillPath << " is corrupt" << std::endl;
+			break;
+		}
+		Memory memory;
+		for (int i = 0; i < keyCount; i++){
+			int key;
+			float value;
+			in.read((char*)&key, sizeof(int));
+			in.read((char*)&value, sizeof(float));
+			memory.encodeVecValue(key, value);
+		}
 
-		newVal += it.second + weight;
+		int pathLength = 0;
+		in.read((char*)&pathLength, sizeof(int));
+		if (!in || pathLength < 0 || pathLength > size - (long long)in.tellg()){
+			std::cout << "MemoryBank::readSpill() error: " << spillPath << " is truncated or corrupt" << std::endl;
+			break;
+		}
+		std::string path(pathLength, ' ');
+		if (pathLength > 0){
+			in.read(&path[0], pathLength);
+		}
+		memory.encodeActions(path);
 
-		this->totalMemVec.encodeVecValue(it.first, newVal);
+		if (!in){
+			std::cout << "MemoryBank::readSpill() error: " << spillPath << " is truncated" << std::endl;
+			break;
+		}
+		spilled.push_back(memory);
 	}
-}
\ No newline at end of file
+	return spilled;
+}
+
+const Memory& MemoryBank::getTotalMemVec() const{
+	return this->totalMemVec;
+}
+
+float MemoryBank::getSquaredLength() const{
+	return (float)this->squaredLength;
+}
+
+//The running sum getSquaredLength rounds, which later memories keep adding to
+double MemoryBank::getExactSquaredLength() const{
+	return this->squaredLength;
+}
+
+//0 while the bank is empty
+float MemoryBank::getInverseLength() const{
+	return this->inverseLength;
+}
+
+float MemoryBank::getNormalizedValue(int key) const{
+	return this->totalMemVec.getVecValue(key) * this->inverseLength;
+}
+
+int MemoryBank::getTimeStep() const{
+	return this->timeStep;
+}
+
+unsigned int MemoryBank::getVersion() const{
+	return this->version;
+}
+
+//Folds the newest memory into the total, touching only the keys it changed
+void MemoryBank::refreshVec(const Memory& memory){
+	float weight = 0.1 * (this->timeStep - 1);
+	this->squaredLength += this->totalMemVec.accumulate(memory, weight);
+
+	if (this->squaredLength > 0){
+		this->inverseLength = (float)(1 / std::sqrt(this->squaredLength));
+	}
+	else {
+		this->inverseLength = 0;
+	}
+}
+
+//Appends memory as [key count][key, value]...[path length][path]. Keys are SymbolTable ids,
+//so a spill file is only meaningful to the process that wrote it
+void MemoryBank::spill(const Memory& memory){
+	this->spilledCount++;
+	if (this->spillFile == NULL){
+		return;
+	}
+	std::ofstream& out = *(this->spillFile);
+
+	const std::vector<int>& keys = memory.getKeys();
+	const std::vector<float>& values = memory.getValues();
+	int keyCount = keys.size();
+	out.write((const char*)&keyCount, sizeof(int));
+	for (int i = 0; i < keyCount; i++){
+		out.write((const char*)&keys[i], sizeof(int));
+		out.write((const char*)&values[i], sizeof(float));
+	}
+
+	std::string path = memory.getActionPath();
+	int pathLength = path.size();
+	out.write((const char*)&pathLength, sizeof(int));
+	out.write(path.data(), pathLength);
+}
+
+size_t MemoryBank::getMemoryUsage() const{
+	size_t bytes = ST::vectorBytes(this->memories) + ST::stringBytes(this->spillPath) + this->totalMemVec.getMemoryUsage();
+	for (auto& memory : this->memories){
+		bytes += memory.getMemoryUsage();
+	}
+	return bytes;
+}
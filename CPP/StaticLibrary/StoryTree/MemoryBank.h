@@ -6,6 +6,9 @@
 
 #include "Memory.h"
 
+#include <fstream>
+#include <memory>
+#include <string>
 #include <vector>
 
 class MemoryBank
@@ -15,14 +18,49 @@ public:
 	~MemoryBank();
 
 	void						addMemory(const Memory& memory);
+	void						setRetention(unsigned int maxMemories, std::string spillPath = "");
+	void						restore(int timeStep, const Memory& totalMemVec, double squaredLength);
+
+	unsigned int				getMemoryCount() const;
+	const Memory*				getMemory(unsigned int index) const;
+	int							getSpilledCount() const;
+	static std::vector<Memory>	readSpill(std::string spillPath);
+
+	const Memory&				getTotalMemVec() const;
+	float						getSquaredLength() const;
+	double						getExactSquaredLength() const;
+	float						getInverseLength() const;
+	float						getNormalizedValue(int key) const;
+	int							getTimeStep() const;
+	unsigned int				getVersion() const;
+	size_t						getMemoryUsage() const;
 
 private:
 	int							timeStep = 0;
+
+	//Bumped by every addMemory, so cached results that read the bank can tell it changed
+	unsigned int				version = 0;
+
+	//Once maxMemories memories are held (0 means no limit) they are a ring buffer and oldest is
+	//where the next one goes. Evicted memories are already part of totalMemVec, so dropping them
+	//doesn't change any score; with a spillPath they are appended to that file first. The file stays
+	//open while the bank spills to it (a copy of the bank writes to the same one)
 	std::vector<Memory>			memories;
+	unsigned int				maxMemories = 0;
+	unsigned int				oldest = 0;
+	std::string					spillPath;
+	std::shared_ptr<std::ofstream>	spillFile;
+	int							spilledCount = 0;
+
+	//The weighted sum of every memory, kept up to date by addMemory along with its sum of squares
+	//and 1 / its length, so the normalised total is totalMemVec scaled by inverseLength
 	Memory						totalMemVec;
+	double						squaredLength = 0;
+	float						inverseLength = 0;
 
-	//private function
-	void						refreshVec();
+	//private functions
+	void						refreshVec(const Memory& memory);
+	void						spill(const Memory& memory);
 };
 
 #endif
\ No newline at end of file
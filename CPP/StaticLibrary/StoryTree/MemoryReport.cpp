@@ -0,0 +1,16 @@
+//MemoryReport.cpp
+#include "stdafx.h"
+#include "MemoryReport.h"
+
+namespace ST{
+
+	size_t CharacterMemoryUsage::total() const{
+		return this->values + this->actionTree + this->compiledTree + this->memoryBank;
+	}
+
+	//The heap, that is, without mappedImage
+	size_t MemoryReport::total() const{
+		return this->sdb + this->symbols + this->characters + this->dependencies + this->optionCache + this->scratch;
+	}
+
+}
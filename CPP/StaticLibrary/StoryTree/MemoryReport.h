@@ -0,0 +1,63 @@
+//MemoryReport.h
+#ifndef MemoryReport_H
+#define MemoryReport_H
+
+#include "stdafx.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+namespace ST{
+
+	//The heap bytes a container holds beyond its own sizeof, as the getMemoryUsage functions count them.
+	//A hash map's nodes are estimated as the value plus two pointers, since neither standard library says
+	template<class T>
+	size_t vectorBytes(const std::vector<T>& v){
+		return v.capacity() * sizeof(T);
+	}
+
+	inline size_t vectorBytes(const std::vector<bool>& v){
+		return v.capacity() / 8;
+	}
+
+	//Short strings are stored inside the string itself
+	inline size_t stringBytes(const std::string& s){
+		static const size_t inPlace = std::string().capacity();
+		return (s.capacity() > inPlace) ? s.capacity() + 1 : 0;
+	}
+
+	template<class Map>
+	size_t hashMapBytes(const Map& map){
+		return map.bucket_count() * sizeof(void*) + map.size() * (sizeof(typename Map::value_type) + 2 * sizeof(void*));
+	}
+
+	//What one character costs, in bytes
+	struct CharacterMemoryUsage{
+		std::string									name;
+		size_t										values = 0;				//characteristics, their versions and the satisfied bits
+		size_t										actionTree = 0;
+		size_t										compiledTree = 0;		//nothing for a tree mapped straight onto a story image
+		size_t										memoryBank = 0;
+
+		size_t										total() const;
+	};
+
+	//What a StoryTree's structures cost, in bytes. mappedImage is the story image's file, which the OS
+	//pages in as it's read rather than the heap holding it
+	struct MemoryReport{
+		size_t										sdb = 0;
+		size_t										symbols = 0;			//every interned name, shared by all StoryTrees
+		size_t										characters = 0;			//perCharacter's totals, plus the CharacterDB holding them
+		size_t										dependencies = 0;
+		size_t										optionCache = 0;
+		size_t										scratch = 0;			//traversal arenas
+		size_t										mappedImage = 0;
+		std::vector<CharacterMemoryUsage>			perCharacter;			//the largest first
+
+		size_t										total() const;
+	};
+
+}
+
+#endif
@@ -0,0 +1,65 @@
+//OptionBatch.cpp
+#include "stdafx.h"
+#include "OptionBatch.h"
+
+#include <iostream>
+
+namespace ST{
+
+	OptionBatch::OptionBatch()
+	{
+		this->clear();
+	}
+
+
+	OptionBatch::~OptionBatch()
+	{
+	}
+
+	void OptionBatch::clear(){
+		this->uids.clear();
+		this->pathOffsets.clear();
+		this->pathOffsets.push_back(0);
+		this->characterOffsets.clear();
+		this->characterOffsets.push_back(0);
+	}
+
+	//Appends the next character's options
+	void OptionBatch::addCharacter(const std::vector<std::vector<int>>& options){
+		for (auto& path : options){
+			this->uids.insert(this->uids.end(), path.begin(), path.end());
+			this->pathOffsets.push_back(this->uids.size());
+		}
+		this->characterOffsets.push_back(this->pathOffsets.size() - 1);
+	}
+
+	unsigned int OptionBatch::getCharacterCount() const{
+		return this->characterOffsets.size() - 1;
+	}
+
+	unsigned int OptionBatch::getOptionCount(unsigned int character) const{
+		if (character >= this->getCharacterCount()){
+			std::cout << "OptionBatch::getOptionCount() error: There's no character at index " << character << std::endl;
+			return 0;
+		}
+		return this->characterOffsets[character + 1] - this->characterOffsets[character];
+	}
+
+	std::vector<int> OptionBatch::getOption(unsigned int character, unsigned int option) const{
+		if (option >= this->getOptionCount(character)){
+			std::cout << "OptionBatch::getOption() error: Character " << character << " has no option " << option << std::endl;
+			return std::vector<int>();
+		}
+		unsigned int path = this->characterOffsets[character] + option;
+		return std::vector<int>(this->uids.begin() + this->pathOffsets[path], this->uids.begin() + this->pathOffsets[path + 1]);
+	}
+
+	std::vector<std::vector<int>> OptionBatch::getOptions(unsigned int character) const{
+		std::vector<std::vector<int>> options;
+		for (unsigned int option = 0; option < this->getOptionCount(character); option++){
+			options.push_back(this->getOption(character, option));
+		}
+		return options;
+	}
+
+}
@@ -0,0 +1,36 @@
+//OptionBatch.h
+#ifndef OptionBatch_H
+#define OptionBatch_H
+
+#include "stdafx.h"
+
+#include <vector>
+
+namespace ST{
+
+	//The options getOptionsBatch found for each character, stored flat.
+	//Character c's options are paths [characterOffsets[c], characterOffsets[c + 1]) and
+	//path p's uids are uids[pathOffsets[p] .. pathOffsets[p + 1])
+	class OptionBatch
+	{
+	public:
+		OptionBatch();
+		~OptionBatch();
+
+		void										clear();
+		void										addCharacter(const std::vector<std::vector<int>>& options);
+
+		unsigned int								getCharacterCount() const;
+		unsigned int								getOptionCount(unsigned int character) const;
+		std::vector<int>							getOption(unsigned int character, unsigned int option) const;
+		std::vector<std::vector<int>>				getOptions(unsigned int character) const;
+
+	private:
+		std::vector<int>							uids;
+		std::vector<unsigned int>					pathOffsets;
+		std::vector<unsigned int>					characterOffsets;
+	};
+
+}
+
+#endif
@@ -0,0 +1,128 @@
+//OptionCache.cpp
+#include "stdafx.h"
+#include "OptionCache.h"
+#include "MemoryReport.h"
+#include "CharacterDB.h"
+
+#include <algorithm>
+
+namespace ST{
+
+	OptionCache::OptionCache()
+	{
+	}
+
+
+	OptionCache::~OptionCache()
+	{
+	}
+
+	//Forgets every result and every character's reads. The counters keep counting
+	void OptionCache::clear(){
+		this->characters.clear();
+	}
+
+	void OptionCache::setReads(int owner, const std::vector<SlotRef>& reads){
+		CharacterCache& cache = this->characters[owner];
+		cache.reads = reads;
+		cache.entries.clear();
+	}
+
+	//Copies the cached result into options if there is one and nothing it read has changed.
+	//Every stale result the scan comes across is dropped and counted as an invalidation; a miss
+	//on a stale result for this key is counted as both
+	bool OptionCache::lookup(int owner, int numOfOptions, float conversationType, unsigned int memoryVersion,
+							 const CharacterDB& characters, std::vector<std::vector<int>>& options){
+		auto cacheIt = this->characters.find(owner);
+		if (cacheIt != this->characters.end()){
+			CharacterCache& cache = cacheIt->second;
+			for (unsigned int i = 0; i < cache.entries.size(); i++){
+				if (!this->isCurrent(cache, cache.entries[i], memoryVersion, characters)){
+					cache.entries.erase(cache.entries.begin() + i);
+					this->invalidations++;
+					i--;
+					continue;
+				}
+
+				Entry& entry = cache.entries[i];
+				if (entry.numOfOptions == numOfOptions && entry.conversationType == conversationType){
+					options = entry.options;
+					std::rotate(cache.entries.begin() + i, cache.entries.begin() + i + 1, cache.entries.end());
+					this->hits++;
+					return true;
+				}
+			}
+		}
+
+		this->misses++;
+		return false;
+	}
+
+	//Replaces any result already stored for the same key, and makes room by dropping the least
+	//recently used result once the character has MAX_ENTRIES
+	void OptionCache::store(int owner, int numOfOptions, float conversationType, unsigned int memoryVersion,
+							const CharacterDB& characters, const std::vector<std::vector<int>>& options){
+		CharacterCache& cache = this->characters[owner];
+		for (unsigned int i = 0; i < cache.entries.size(); i++){
+			if (cache.entries[i].numOfOptions == numOfOptions && cache.entries[i].conversationType == conversationType){
+				cache.entries.erase(cache.entries.begin() + i);
+				break;
+			}
+		}
+		if (cache.entries.size() >= MAX_ENTRIES){
+			cache.entries.erase(cache.entries.begin());
+		}
+
+		Entry entry;
+		entry.numOfOptions = numOfOptions;
+		entry.conversationType = conversationType;
+		entry.memoryVersion = memoryVersion;
+		entry.options = options;
+		for (auto& read : cache.reads){
+			const Character* myChar = characters.getCharacter(read.character);
+			entry.slotVersions.push_back(myChar == NULL ? 0 : myChar->getVersion(read.slot));
+		}
+		cache.entries.push_back(entry);
+	}
+
+	unsigned long long OptionCache::getHits() const{
+		return this->hits;
+	}
+
+	unsigned long long OptionCache::getMisses() const{
+		return this->misses;
+	}
+
+	unsigned long long OptionCache::getInvalidations() const{
+		return this->invalidations;
+	}
+
+	bool OptionCache::isCurrent(const CharacterCache& cache, const Entry& entry, unsigned int memoryVersion, const CharacterDB& characters) const{
+		if (entry.memoryVersion != memoryVersion){
+			return false;
+		}
+		for (unsigned int i = 0; i < cache.reads.size(); i++){
+			const Character* myChar = characters.getCharacter(cache.reads[i].character);
+			unsigned int version = (myChar == NULL) ? 0 : myChar->getVersion(cache.reads[i].slot);
+			if (version != entry.slotVersions[i]){
+				return false;
+			}
+		}
+		return true;
+	}
+
+	size_t OptionCache::getMemoryUsage() const{
+		size_t bytes = hashMapBytes(this->characters);
+		for (auto& character : this->characters){
+			bytes += vectorBytes(character.second.reads) + vectorBytes(character.second.entries);
+			for (auto& entry : character.second.entries){
+				bytes += vectorBytes(entry.slotVersions) + vectorBytes(entry.options);
+				for (auto& path : entry.options){
+					bytes += vectorBytes(path);
+				}
+			}
+		}
+		return bytes;
+	}
+
+}
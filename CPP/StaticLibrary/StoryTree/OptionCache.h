@@ -0,0 +1,74 @@
+//OptionCache.h
+#ifndef OptionCache_H
+#define OptionCache_H
+
+#include "stdafx.h"
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+
+class CharacterDB;
+
+namespace ST{
+
+	//A value some character's getOptions reads: the slot of the character with the given id
+	struct SlotRef{
+		int											character;
+		int											slot;
+	};
+
+	//getOptions results per character, keyed on (number of options, conversation type).
+	//Each result remembers the version of every slot the character's actions read and of its
+	//MemoryBank, and is only returned while all of them are unchanged. A character keeps at most
+	//MAX_ENTRIES results, dropping the least recently used
+	class OptionCache
+	{
+	public:
+		static const unsigned int					MAX_ENTRIES = 4;
+
+		OptionCache();
+		~OptionCache();
+
+		void										clear();
+		void										setReads(int owner, const std::vector<SlotRef>& reads);
+
+		bool										lookup(int owner, int numOfOptions, float conversationType, unsigned int memoryVersion,
+														   const CharacterDB& characters, std::vector<std::vector<int>>& options);
+		void										store(int owner, int numOfOptions, float conversationType, unsigned int memoryVersion,
+														  const CharacterDB& characters, const std::vector<std::vector<int>>& options);
+
+		unsigned long long							getHits() const;
+		unsigned long long							getMisses() const;
+		unsigned long long							getInvalidations() const;
+		size_t										getMemoryUsage() const;
+
+	private:
+		struct Entry{
+			int										numOfOptions;
+			float									conversationType;
+			unsigned int							memoryVersion;
+			std::vector<unsigned int>				slotVersions;
+			std::vector<std::vector<int>>			options;
+		};
+
+		//reads is fixed by the character's actions; slotVersions[i] is the version reads[i] had.
+		//entries are in the order they were last used, most recent last
+		struct CharacterCache{
+			std::vector<SlotRef>					reads;
+			std::vector<Entry>						entries;
+		};
+
+		std::unordered_map<int, CharacterCache>		characters;
+
+		unsigned long long							hits = 0;
+		unsigned long long							misses = 0;
+		unsigned long long							invalidations = 0;
+
+		//private function
+		bool										isCurrent(const CharacterCache& cache, const Entry& entry, unsigned int memoryVersion, const CharacterDB& characters) const;
+	};
+
+}
+
+#endif
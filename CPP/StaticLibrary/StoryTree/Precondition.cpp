@@ -7,12 +7,20 @@
 namespace ST{
 
 	Precondition::Precondition(std::string character, std::string cls, std::string type, std::string operation, int value){
-		this->character = character;
-		this->cls = cls;
-		this->type = type;
-		this->operation = operation;
+		this->characterID = SymbolTable::global().intern(character);
+		this->clsID = SymbolTable::global().intern(cls);
+		this->typeID = SymbolTable::global().intern(type);
 
-		if (operation != ">" && operation != "<" && operation != "=="){
+		if (operation == "<"){
+			this->opcode = PRE_LESS;
+		}
+		else if (operation == ">"){
+			this->opcode = PRE_GREATER;
+		}
+		else if (operation == "=="){
+			this->opcode = PRE_EQUAL;
+		}
+		else {
 			std::cout << "Precondition() Error: Your operation of '" << operation << "' has to be '>', '<', or '=='." << std::endl;
 			exit(-1);
 		}
@@ -23,10 +31,10 @@ namespace ST{
 	}
 	
 	Precondition::Precondition(std::string character, std::string cls, std::string type, bool value){
-		this->character = character;
-		this->cls = cls;
-		this->type = type;
-		this->operation = "==";
+		this->characterID = SymbolTable::global().intern(character);
+		this->clsID = SymbolTable::global().intern(cls);
+		this->typeID = SymbolTable::global().intern(type);
+		this->opcode = PRE_EQUAL;
 
 		this->isBoolean = true;
 
@@ -42,22 +50,78 @@ namespace ST{
 	{
 	}
 
-	bool Precondition::evaluate(int value){
-		if (this->operation == "<"){
-			return (this->intValue < value);
-		}
-		else if (this->operation == ">"){
-			return (this->intValue > value);
+	//value is the characteristic's current value, compared against this precondition's value
+	bool Precondition::evaluate(int value) const{
+		if (this->opcode == PRE_LESS){
+			return (value < this->intValue);
 		}
-		else if (this->operation == "=="){
-			return (this->intValue == value);
+		else if (this->opcode == PRE_GREATER){
+			return (value > this->intValue);
 		}
-		else{
-			return false;
+		else {
+			return (value == this->intValue);
 		}
 	}
 
-	bool Precondition::evaluate(bool value){
+	bool Precondition::evaluate(bool value) const{
 		return (this->boolValue == value);
 	}
+
+	std::string Precondition::getCharacter() const{
+		return SymbolTable::global().getName(this->characterID);
+	}
+
+	std::string Precondition::getClass() const{
+		return SymbolTable::global().getName(this->clsID);
+	}
+
+	std::string Precondition::getType() const{
+		return SymbolTable::global().getName(this->typeID);
+	}
+
+	std::string Precondition::getOperation() const{
+		if (this->opcode == PRE_LESS){
+			return "<";
+		}
+		else if (this->opcode == PRE_GREATER){
+			return ">";
+		}
+		return "==";
+	}
+
+	int Precondition::getOpcode() const{
+		return (this->opcode);
+	}
+
+	int Precondition::getIntValue() const{
+		return (this->intValue);
+	}
+
+	bool Precondition::getBoolValue() const{
+		return (this->boolValue);
+	}
+
+	bool Precondition::boolean() const{
+		return (this->isBoolean);
+	}
+
+	int Precondition::getCharacterID() const{
+		return (this->characterID);
+	}
+
+	int Precondition::getClassID() const{
+		return (this->clsID);
+	}
+
+	int Precondition::getTypeID() const{
+		return (this->typeID);
+	}
+
+	void Precondition::setSlot(int slot){
+		this->slot = slot;
+	}
+
+	int Precondition::getSlot() const{
+		return (this->slot);
+	}
 }
\ No newline at end of file
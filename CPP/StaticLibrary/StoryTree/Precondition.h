@@ -1,9 +1,21 @@
 //Precondition.h
 #pragma once
 
+#include "SymbolTable.h"
+
 #include <string>
 
 namespace ST{
+
+	//An opcode is the set of comparison outcomes that pass, so evaluating one is a mask test.
+	//The bits are ordered so an outcome is 1 << (sign(value - operand) + 1)
+	enum PreconditionOpcode{
+		PRE_FAIL = 0,
+		PRE_LESS = 1,
+		PRE_EQUAL = 2,
+		PRE_GREATER = 4
+	};
+
 	class Precondition
 	{
 	public:
@@ -12,19 +24,42 @@ namespace ST{
 		Precondition();
 		~Precondition();
 
-		bool								evaluate(int value);
-		bool								evaluate(bool value);
+		bool								evaluate(int value) const;
+		bool								evaluate(bool value) const;
+
+		std::string							getCharacter() const;
+		std::string							getClass() const;
+		std::string							getType() const;
+		std::string							getOperation() const;
+		int									getOpcode() const;
+		int									getIntValue() const;
+		bool								getBoolValue() const;
+		bool								boolean() const;
+
+		int									getCharacterID() const;
+		int									getClassID() const;
+		int									getTypeID() const;
+
+		void								setSlot(int slot);
+		int									getSlot() const;
 
 	private:
-		std::string							character;
-		std::string							cls;
-		std::string							type;
-		std::string							operation;
-		
-		int									intValue;
-		bool								boolValue;
-
-		bool								isBoolean;
+		//Interned ids of character, cls and type. The names themselves only live in the SymbolTable,
+		//so a Precondition is a handful of ints
+		int									characterID = SymbolTable::NONE;
+		int									clsID = SymbolTable::NONE;
+		int									typeID = SymbolTable::NONE;
+
+		//SDB slot of cls:type, resolved when the action is added to a StoryTree
+		int									slot = -1;
+
+		//A PreconditionOpcode
+		int									opcode = PRE_EQUAL;
+
+		int									intValue = 0;
+		bool								boolValue = false;
+
+		bool								isBoolean = false;
 	};
 
 }
\ No newline at end of file
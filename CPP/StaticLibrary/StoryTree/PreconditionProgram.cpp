@@ -0,0 +1,75 @@
+//PreconditionProgram.cpp
+#include "stdafx.h"
+#include "PreconditionProgram.h"
+#include "CharacterDB.h"
+
+namespace ST{
+
+	PreconditionProgram::PreconditionProgram()
+	{
+	}
+
+
+	PreconditionProgram::~PreconditionProgram()
+	{
+	}
+
+	//Preconditions need their slots resolved first; one without a slot compiles to PRE_FAIL
+	void PreconditionProgram::compile(const std::vector<Precondition>& preconditions){
+		this->ops.clear();
+		for (auto& pre : preconditions){
+			PreconditionOp op;
+			op.character = pre.getCharacterID();
+			op.slot = pre.getSlot();
+
+			op.opcode = pre.getOpcode();
+			if (pre.boolean()){
+				op.operand = pre.getBoolValue() ? 1 : 0;
+			}
+			else {
+				op.operand = pre.getIntValue();
+			}
+
+			if (op.slot < 0){
+				op.opcode = PRE_FAIL;
+				op.slot = 0;
+			}
+			this->ops.push_back(op);
+		}
+	}
+
+	bool PreconditionProgram::evaluate(const CharacterDB& characters) const{
+		return PreconditionProgram::evaluate(this->ops.data(), this->ops.size(), characters);
+	}
+
+	//Evaluates count ops wherever they're stored, such as a CompiledTree or a mapped StoryImage,
+	//counting what ran into stats if it's given
+	bool PreconditionProgram::evaluate(const PreconditionOp* ops, unsigned int count, const CharacterDB& characters, StoryStats* stats){
+		for (unsigned int i = 0; i < count; i++){
+			const PreconditionOp& op = ops[i];
+			const Character* myChar = characters.getCharacter(op.character);
+			bool holds = false;
+			if (myChar != NULL){
+				int value = myChar->getValue(op.slot);
+				int outcome = 1 << ((value > op.operand) - (value < op.operand) + 1);
+				holds = (outcome & op.opcode) != 0;
+			}
+			if (!holds){
+				if (stats != NULL){
+					ST_STATS_ADD(*stats, preconditionsEvaluated, i + 1);
+					ST_STATS_ADD(*stats, preconditionsShortCircuited, count - i - 1);
+				}
+				return false;
+			}
+		}
+		if (stats != NULL){
+			ST_STATS_ADD(*stats, preconditionsEvaluated, count);
+		}
+		return true;
+	}
+
+	const std::vector<PreconditionOp>& PreconditionProgram::getOps() const{
+		return this->ops;
+	}
+
+}
@@ -0,0 +1,43 @@
+//PreconditionProgram.h
+#ifndef PreconditionProgram_H
+#define PreconditionProgram_H
+
+#include "stdafx.h"
+
+#include "Precondition.h"
+#include "StoryStats.h"
+
+#include <vector>
+
+class CharacterDB;
+
+namespace ST{
+
+	struct PreconditionOp{
+		int									character;
+		int									slot;
+		int									opcode;
+		int									operand;
+	};
+
+	//An Action's preconditions compiled into (slot, opcode, operand) triples when the action is
+	//loaded, so evaluating them never compares operation strings or looks up a characteristic by name
+	class PreconditionProgram
+	{
+	public:
+		PreconditionProgram();
+		~PreconditionProgram();
+
+		void								compile(const std::vector<Precondition>& preconditions);
+		bool								evaluate(const CharacterDB& characters) const;
+		static bool							evaluate(const PreconditionOp* ops, unsigned int count, const CharacterDB& characters, StoryStats* stats = NULL);
+
+		const std::vector<PreconditionOp>&	getOps() const;
+
+	private:
+		std::vector<PreconditionOp>			ops;
+	};
+
+}
+
+#endif
@@ -1,5 +1,9 @@
 #include "stdafx.h"
 #include "SDB.h"
+#include "MemoryReport.h"
+#include "SymbolTable.h"
+
+#include <iostream>
 
 
 
@@ -11,11 +15,75 @@ SDB::~SDB(){
 }
 
 void SDB::addClass(const ST::SDBClass& cls){
-	this->classes[cls.getName()] = cls;
+	ST::SymbolTable& symbols = ST::SymbolTable::global();
+	int clsID = symbols.intern(cls.getName());
+	this->classes[clsID] = cls;
+
+	std::unordered_map<int, int>& clsSlots = this->slots[clsID];
+	for (auto& type : cls.getTypeNames()){
+		int typeID = symbols.intern(type);
+		if (clsSlots.find(typeID) == clsSlots.end()){
+			clsSlots[typeID] = this->slotInfo.size();
+			this->slotInfo.push_back(SDBSlot());
+		}
+
+		SDBSlot& slot = this->slotInfo[clsSlots[typeID]];
+		slot.clsID = clsID;
+		slot.typeID = typeID;
+		slot.isBoolean = cls.boolean();
+		if (cls.boolean()){
+			slot.defaultVal = cls.getDefaultBoolVal() ? 1 : 0;
+			slot.min = 0;
+			slot.max = 1;
+		}
+		else {
+			slot.defaultVal = cls.getDefaultIntVal();
+			slot.min = cls.getMin();
+			slot.max = cls.getMax();
+		}
+	}
+}
+
+//Appends one class:type slot as it was laid out elsewhere, like a story image, so slot numbers
+//come out the same no matter what order the classes were first added in
+void SDB::addSlot(const SDBSlot& slot){
+	ST::SymbolTable& symbols = ST::SymbolTable::global();
+	std::unordered_map<int, int>& clsSlots = this->slots[slot.clsID];
+	if (clsSlots.find(slot.typeID) != clsSlots.end()){
+		std::cout << "SDB::addSlot() error: " << symbols.getName(slot.clsID) << ":"
+				  << symbols.getName(slot.typeID) << " already has a slot" << std::endl;
+		exit(-1);
+	}
+	clsSlots[slot.typeID] = this->slotInfo.size();
+	this->slotInfo.push_back(slot);
+
+	const std::string& type = symbols.getName(slot.typeID);
+	auto clsIt = this->classes.find(slot.clsID);
+	if (clsIt != this->classes.end()){
+		clsIt->second.addTypes(type);
+	}
+	else if (slot.isBoolean){
+		this->classes[slot.clsID] = ST::SDBClass(symbols.getName(slot.clsID), std::vector<std::string>(1, type), slot.defaultVal != 0);
+	}
+	else {
+		this->classes[slot.clsID] = ST::SDBClass(symbols.getName(slot.clsID), std::vector<std::string>(1, type), slot.defaultVal, slot.min, slot.max);
+	}
 }
 
 ST::SDBClass SDB::getClass(std::string cls){
-	return this->classes[cls];
+	return this->classes[ST::SymbolTable::global().intern(cls)];
+}
+
+const ST::SDBClass* SDB::findClass(std::string name) const{
+	return this->findClass(ST::SymbolTable::global().find(name));
+}
+
+const ST::SDBClass* SDB::findClass(int nameID) const{
+	auto clsIt = this->classes.find(nameID);
+	if (clsIt == this->classes.end()){
+		return NULL;
+	}
+	return &(clsIt->second);
 }
 
 bool SDB::isEmpty(){
@@ -23,19 +91,47 @@ bool SDB::isEmpty(){
 }
 
 bool SDB::doesContain(std::string cls, std::string type){
-	auto clsIt = this->classes.find(cls);
+	auto clsIt = this->classes.find(ST::SymbolTable::global().find(cls));
 
 	if (clsIt == this->classes.end()){
 		return false;
 	}
 
-	ST::SDBClass myClass = clsIt->second;
+	return clsIt->second.hasType(type);
+}
+
+//Returns the slot of class:type, or -1 if the SDB doesn't have it
+int SDB::getSlot(int clsID, int typeID) const{
+	auto clsIt = this->slots.find(clsID);
+	if (clsIt == this->slots.end()){
+		return -1;
+	}
+	auto typeIt = clsIt->second.find(typeID);
+	if (typeIt == clsIt->second.end()){
+		return -1;
+	}
+	return typeIt->second;
+}
 
-	std::string* types = myClass.getTypes();
+unsigned int SDB::getSlotCount() const{
+	return this->slotInfo.size();
+}
 
-	if (types->size() == 0){
-		return false;
+const SDBSlot& SDB::getSlotInfo(int slot) const{
+	if (slot < 0 || slot >= (int)this->slotInfo.size()){
+		std::cout << "SDB::getSlotInfo() error: There's no slot " << slot << std::endl;
+		exit(-1);
 	}
+	return this->slotInfo[slot];
+}
 
-	return true;
-}
\ No newline at end of file
+size_t SDB::getMemoryUsage() const{
+	size_t bytes = ST::hashMapBytes(this->classes) + ST::hashMapBytes(this->slots) + ST::vectorBytes(this->slotInfo);
+	for (auto& cls : this->classes){
+		bytes += cls.second.getMemoryUsage();
+	}
+	for (auto& cls : this->slots){
+		bytes += ST::hashMapBytes(cls.second);
+	}
+	return bytes;
+}
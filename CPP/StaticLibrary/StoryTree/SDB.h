@@ -6,21 +6,46 @@
 
 #include <unordered_map>
 #include <string>
+#include <vector>
 
 #include "SDBClass.h"
 
+//Everything needed to read or change one class:type value in a Character's value array
+struct SDBSlot {
+	int																clsID;
+	int																typeID;
+	bool															isBoolean;
+	int																defaultVal;
+	int																min;
+	int																max;
+};
+
 class SDB {
 public:
 	SDB();
 	~SDB();
 
 	void															addClass(const ST::SDBClass& cls);
+	void															addSlot(const SDBSlot& slot);
 	ST::SDBClass													getClass(std::string name);
+	const ST::SDBClass*												findClass(std::string name) const;
+	const ST::SDBClass*												findClass(int nameID) const;
 	bool															isEmpty();
 	bool															doesContain(std::string cls, std::string type);
 
+	int																getSlot(int clsID, int typeID) const;
+	unsigned int													getSlotCount() const;
+	const SDBSlot&													getSlotInfo(int slot) const;
+	size_t															getMemoryUsage() const;
+
 private:
-	std::unordered_map<std::string, ST::SDBClass>					classes;
+	//Keyed by the interned class name
+	std::unordered_map<int, ST::SDBClass>							classes;
+
+	//Every class:type pair gets a fixed slot, its offset into each Character's value array.
+	//Slots are never reused, so re-adding a class only appends slots for its new types
+	std::unordered_map<int, std::unordered_map<int, int>>			slots;
+	std::vector<SDBSlot>											slotInfo;
 };
 
 #endif
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "stdafx.h"
 
 #include "SDBClass.h"
+#include "MemoryReport.h"
 
 #include <string>
 #include <vector>
@@ -41,7 +42,7 @@ namespace ST{
 
 		//Set each value of the map
 		for (auto it = types.begin(); it != types.end(); ++it){
-			this->types[*it] = true;
+			this->addTypes(*it);
 		}
 	}
 
@@ -55,7 +56,7 @@ namespace ST{
 
 		//Set each value of the map
 		for (auto it = types.begin(); it != types.end(); ++it){
-			this->types[*it] = true;
+			this->addTypes(*it);
 		}
 	}
 
@@ -87,7 +88,7 @@ namespace ST{
 		for (unsigned int i = 0; i < types->size(); ++i){
 			std::string type = types[i];
 
-			this->types[type] = true;
+			this->addTypes(type);
 		}
 	}
 
@@ -103,7 +104,7 @@ namespace ST{
 		for (unsigned int i = 0; i < types->size(); ++i){
 			std::string type = types[i];
 
-			this->types[type] = true;
+			this->addTypes(type);
 		}
 	}
 
@@ -113,17 +114,20 @@ namespace ST{
 
 	void SDBClass::addTypes(std::vector<std::string> types){
 		for (auto it = types.begin(); it != types.end(); ++it){
-			this->types[*it] = true;
+			this->addTypes(*it);
 		}
 	}
 
 	void SDBClass::addTypes(std::string types[]){
 		for (unsigned int i = 0; i < types->size(); i++){
-			this->types[types[i]] = true;
+			this->addTypes(types[i]);
 		}
 	}
 
 	void SDBClass::addTypes(std::string type){
+		if (this->types.find(type) == this->types.end()){
+			this->typeNames.push_back(type);
+		}
 		this->types[type] = true;
 	}
 
@@ -131,25 +135,57 @@ namespace ST{
 		return this->name;
 	}
 
-	std::string* SDBClass::getTypes(){
-		std::string* tehTypes = new std::string[this->types.size()];
-		int count = 0;
-		for (auto it = this->types.begin(); it != this->types.end(); ++it){
-			tehTypes[count] = (it)->first;
-		}
-		return tehTypes;
+	//Types in the order they were added. This used to hand back a new[]ed array nobody freed
+	std::vector<std::string> SDBClass::getTypes(){
+		return this->typeNames;
 	}
 
 	std::string SDBClass::getName() const{
 		return this->name;
 	}
 
-	std::string* SDBClass::getTypes() const{
-		std::string* tehTypes = new std::string[this->types.size()];
-		int count = 0;
-		for (auto it = this->types.begin(); it != this->types.end(); ++it){
-			tehTypes[count] = (it)->first;
+	std::vector<std::string> SDBClass::getTypes() const{
+		return this->typeNames;
+	}
+
+	bool SDBClass::boolean() const{
+		return this->isBoolean;
+	}
+
+	//Types in the order they were added
+	const std::vector<std::string>& SDBClass::getTypeNames() const{
+		return this->typeNames;
+	}
+
+	bool SDBClass::hasType(std::string type) const{
+		return (this->types.find(type) != this->types.end());
+	}
+
+	int SDBClass::getDefaultIntVal() const{
+		return this->defaultIntVal;
+	}
+
+	bool SDBClass::getDefaultBoolVal() const{
+		return this->defaultBoolVal;
+	}
+
+	int SDBClass::getMin() const{
+		return this->min;
+	}
+
+	int SDBClass::getMax() const{
+		return this->max;
+	}
+
+	//Heap bytes beyond the class itself, as for every getMemoryUsage
+	size_t SDBClass::getMemoryUsage() const{
+		size_t bytes = stringBytes(this->name) + hashMapBytes(this->types) + vectorBytes(this->typeNames);
+		for (auto& type : this->types){
+			bytes += stringBytes(type.first);
+		}
+		for (auto& type : this->typeNames){
+			bytes += stringBytes(type);
 		}
-		return tehTypes;
+		return bytes;
 	}
-}
\ No newline at end of file
+}
@@ -26,20 +26,30 @@ namespace ST{
 		void									addTypes(std::string type);
 
 		std::string								getName();
-		std::string*						    getTypes();
+		std::vector<std::string>				getTypes();
 		std::string								getName() const;
-		std::string*						    getTypes() const;
+		std::vector<std::string>				getTypes() const;
+
+		bool									boolean() const;
+		const std::vector<std::string>&			getTypeNames() const;
+		bool									hasType(std::string type) const;
+		int										getDefaultIntVal() const;
+		bool									getDefaultBoolVal() const;
+		int										getMin() const;
+		int										getMax() const;
+		size_t									getMemoryUsage() const;
 
 	private:
 		std::string								name;
 		std::unordered_map<std::string, bool> 	types;
-		bool									isBoolean;
+		std::vector<std::string>				typeNames;
+		bool									isBoolean = false;
 		
-		bool									defaultBoolVal;
+		bool									defaultBoolVal = false;
 
-		int										defaultIntVal;
-		int										min;
-		int										max;
+		int										defaultIntVal = 0;
+		int										min = 0;
+		int										max = 0;
 	};
 }
 
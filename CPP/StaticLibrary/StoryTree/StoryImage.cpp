@@ -0,0 +1,388 @@
+//StoryImage.cpp
+#include "stdafx.h"
+#include "StoryImage.h"
+#include "SymbolTable.h"
+#include "SDB.h"
+#include "CharacterDB.h"
+#include "ActionTreeValidator.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <set>
+#include <utility>
+#include <vector>
+
+namespace ST{
+
+	//Appends a section's bytes to the image, padded to 8 bytes, and returns where it starts
+	template<class T>
+	static unsigned int appendSection(std::vector<char>& image, const T* data, unsigned int count){
+		image.resize((image.size() + 7) & ~(size_t)7, 0);
+		unsigned int offset = image.size();
+		if (count > 0){
+			const char* bytes = (const char*)data;
+			image.insert(image.end(), bytes, bytes + count * sizeof(T));
+		}
+		return offset;
+	}
+
+	StoryImage::StoryImage()
+	{
+	}
+
+
+	StoryImage::~StoryImage()
+	{
+	}
+
+	//Writes the world sdb and characters describe, with every character's values as they are now.
+	//The characters' trees have to be compiled first
+	bool StoryImage::write(std::string path, const SDB& sdb, CharacterDB& characters){
+		StoryImageHeader header;
+		std::fill((char*)&header, (char*)&header + sizeof(header), 0);
+		header.magic = STORY_IMAGE_MAGIC;
+		header.version = STORY_IMAGE_VERSION;
+		header.headerSize = sizeof(StoryImageHeader);
+
+		SymbolTable& symbols = SymbolTable::global();
+		std::vector<unsigned int> stringOffsets;
+		std::vector<char> stringData;
+		stringOffsets.push_back(0);
+		unsigned int symbolCount = symbols.size();
+		for (unsigned int id = 0; id < symbolCount; id++){
+			const std::string& name = symbols.getName(id);
+			stringData.insert(stringData.end(), name.begin(), name.end());
+			stringOffsets.push_back(stringData.size());
+		}
+
+		std::vector<ImageSlot> slots;
+		for (unsigned int slot = 0; slot < sdb.getSlotCount(); slot++){
+			const SDBSlot& info = sdb.getSlotInfo(slot);
+			ImageSlot imageSlot = { info.clsID, info.typeID, info.isBoolean ? 1 : 0, info.defaultVal, info.min, info.max };
+			slots.push_back(imageSlot);
+		}
+
+		//Characters go in name id order, so writing the same world twice gives the same file
+		std::vector<int> nameIDs;
+		for (auto& name : characters.getListOfCharacters()){
+			nameIDs.push_back(symbols.find(name));
+		}
+		std::sort(nameIDs.begin(), nameIDs.end());
+
+		std::vector<ImageCharacter> imageCharacters;
+		std::vector<CompiledAction> actions;
+		std::vector<CompiledActionInfo> infos;
+		std::vector<UIDIndex> uids;
+		std::vector<int> firsts;
+		std::vector<int> children;
+		std::vector<PreconditionOp> preconditions;
+		std::vector<ExpressionOp> expressions;
+		std::vector<int> values;
+		std::vector<unsigned int> nameOffsets;
+		std::vector<char> nameData;
+		for (auto& nameID : nameIDs){
+			const Character* myChar = characters.getCharacter(nameID);
+			const CompiledTreeView& view = myChar->getCompiledTree().getView();
+
+			ImageCharacter imageChar;
+			imageChar.nameID = nameID;
+			imageChar.actionBegin = actions.size();
+			imageChar.actionCount = view.actionCount;
+			imageChar.firstBegin = firsts.size();
+			imageChar.firstCount = view.firstCount;
+			imageChar.childBegin = children.size();
+			imageChar.childCount = view.childCount;
+			imageChar.preconditionBegin = preconditions.size();
+			imageChar.preconditionCount = view.preconditionCount;
+			imageChar.expressionBegin = expressions.size();
+			imageChar.expressionCount = view.expressionCount;
+			imageChar.classCount = view.classCount;
+			imageChar.nameBegin = nameOffsets.size();
+			imageChar.nameCount = view.nameCount;
+			imageCharacters.push_back(imageChar);
+
+			actions.insert(actions.end(), view.actions, view.actions + view.actionCount);
+			infos.insert(infos.end(), view.infos, view.infos + view.actionCount);
+			uids.insert(uids.end(), view.uids, view.uids + view.actionCount);
+			firsts.insert(firsts.end(), view.firsts, view.firsts + view.firstCount);
+			children.insert(children.end(), view.children, view.children + view.childCount);
+			preconditions.insert(preconditions.end(), view.preconditions, view.preconditions + view.preconditionCount);
+			expressions.insert(expressions.end(), view.expressions, view.expressions + view.expressionCount);
+			for (unsigned int slot = 0; slot < slots.size(); slot++){
+				values.push_back(myChar->getValue(slot));
+			}
+
+			//A mapped tree's name offsets are into the whole image's names, so they're rebased onto these
+			unsigned int nameBase = nameData.size();
+			nameOffsets.push_back(nameBase);
+			if (view.nameCount > 0){
+				for (unsigned int name = 1; name <= view.nameCount; name++){
+					nameOffsets.push_back(nameBase + view.nameOffsets[name] - view.nameOffsets[0]);
+				}
+				nameData.insert(nameData.end(), view.nameData + view.nameOffsets[0], view.nameData + view.nameOffsets[view.nameCount]);
+			}
+		}
+
+		std::vector<char> image(sizeof(StoryImageHeader), 0);
+		header.stringCount = symbolCount;
+		header.stringOffsets = appendSection(image, stringOffsets.data(), stringOffsets.size());
+		header.stringData = appendSection(image, stringData.data(), stringData.size());
+		header.slotCount = slots.size();
+		header.slots = appendSection(image, slots.data(), slots.size());
+		header.characterCount = imageCharacters.size();
+		header.characters = appendSection(image, imageCharacters.data(), imageCharacters.size());
+		header.actionCount = actions.size();
+		header.actions = appendSection(image, actions.data(), actions.size());
+		header.infos = appendSection(image, infos.data(), infos.size());
+		header.uids = appendSection(image, uids.data(), uids.size());
+		header.firstCount = firsts.size();
+		header.firsts = appendSection(image, firsts.data(), firsts.size());
+		header.childCount = children.size();
+		header.children = appendSection(image, children.data(), children.size());
+		header.preconditionCount = preconditions.size();
+		header.preconditions = appendSection(image, preconditions.data(), preconditions.size());
+		header.expressionCount = expressions.size();
+		header.expressions = appendSection(image, expressions.data(), expressions.size());
+		header.values = appendSection(image, values.data(), values.size());
+		header.nameOffsetCount = nameOffsets.size();
+		header.nameOffsets = appendSection(image, nameOffsets.data(), nameOffsets.size());
+		header.nameDataSize = nameData.size();
+		header.nameData = appendSection(image, nameData.data(), nameData.size());
+		header.fileSize = image.size();
+		std::copy((const char*)&header, (const char*)&header + sizeof(header), image.begin());
+
+		std::ofstream out(path, std::ios::binary | std::ios::trunc);
+		if (!out){
+			std::cout << "StoryImage::write() error: Couldn't open " << path << std::endl;
+			return false;
+		}
+		out.write(image.data(), image.size());
+		return (bool)out;
+	}
+
+	//Maps the image at path and checks every offset and index in it, so a truncated or corrupt file
+	//is rejected here instead of being read out of bounds later
+	bool StoryImage::open(std::string path){
+		this->header = NULL;
+		if (!this->file.open(path)){
+			return false;
+		}
+		if (this->file.getSize() < sizeof(StoryImageHeader)){
+			std::cout << "StoryImage::open() error: " << path << " is too small to be a story image" << std::endl;
+			this->file.close();
+			return false;
+		}
+
+		this->header = (const StoryImageHeader*)this->file.getData();
+		if (!this->validate(path)){
+			this->header = NULL;
+			this->file.close();
+			return false;
+		}
+		return true;
+	}
+
+	const StoryImageHeader& StoryImage::getHeader() const{
+		return *(this->header);
+	}
+
+	std::string StoryImage::getString(unsigned int id) const{
+		const unsigned int* offsets = this->section<unsigned int>(this->header->stringOffsets);
+		const char* data = this->section<char>(this->header->stringData);
+		return std::string(data + offsets[id], data + offsets[id + 1]);
+	}
+
+	const ImageSlot& StoryImage::getSlot(unsigned int slot) const{
+		return this->section<ImageSlot>(this->header->slots)[slot];
+	}
+
+	const ImageCharacter& StoryImage::getCharacter(unsigned int character) const{
+		return this->section<ImageCharacter>(this->header->characters)[character];
+	}
+
+	CompiledTreeView StoryImage::getTreeView(unsigned int character) const{
+		const ImageCharacter& imageChar = this->getCharacter(character);
+
+		CompiledTreeView view;
+		view.actions = this->section<CompiledAction>(this->header->actions) + imageChar.actionBegin;
+		view.actionCount = imageChar.actionCount;
+		view.infos = this->section<CompiledActionInfo>(this->header->infos) + imageChar.actionBegin;
+		view.uids = this->section<UIDIndex>(this->header->uids) + imageChar.actionBegin;
+		view.firsts = this->section<int>(this->header->firsts) + imageChar.firstBegin;
+		view.firstCount = imageChar.firstCount;
+		view.children = this->section<int>(this->header->children) + imageChar.childBegin;
+		view.childCount = imageChar.childCount;
+		view.preconditions = this->section<PreconditionOp>(this->header->preconditions) + imageChar.preconditionBegin;
+		view.preconditionCount = imageChar.preconditionCount;
+		view.expressions = this->section<ExpressionOp>(this->header->expressions) + imageChar.expressionBegin;
+		view.expressionCount = imageChar.expressionCount;
+		view.classCount = imageChar.classCount;
+		view.nameOffsets = this->section<unsigned int>(this->header->nameOffsets) + imageChar.nameBegin;
+		view.nameData = this->section<char>(this->header->nameData);
+		view.nameCount = imageChar.nameCount;
+		return view;
+	}
+
+	const int* StoryImage::getValues(unsigned int character) const{
+		return this->section<int>(this->header->values) + character * this->header->slotCount;
+	}
+
+	template<class T>
+	const T* StoryImage::section(unsigned int offset) const{
+		return (const T*)(this->file.getData() + offset);
+	}
+
+	bool StoryImage::validate(std::string path) const{
+		const StoryImageHeader& header = *(this->header);
+		unsigned long long size = this->file.getSize();
+		std::string error;
+
+		//Whether count Ts at offset fit in the file
+		auto fits = [size](unsigned int offset, unsigned long long count, unsigned long long elementSize){
+			return offset % 4 == 0 && offset + count * elementSize <= size;
+		};
+
+		if (header.magic != STORY_IMAGE_MAGIC){
+			error = "isn't a story image";
+		}
+		else if (header.version != STORY_IMAGE_VERSION || header.headerSize != sizeof(StoryImageHeader)){
+			error = "was written by a different version of the library";
+		}
+		else if (header.fileSize != size){
+			error = "is truncated";
+		}
+		else if (!fits(header.stringOffsets, header.stringCount + 1ull, sizeof(unsigned int)) ||
+				 !fits(header.slots, header.slotCount, sizeof(ImageSlot)) ||
+				 !fits(header.characters, header.characterCount, sizeof(ImageCharacter)) ||
+				 !fits(header.actions, header.actionCount, sizeof(CompiledAction)) ||
+				 !fits(header.infos, header.actionCount, sizeof(CompiledActionInfo)) ||
+				 !fits(header.uids, header.actionCount, sizeof(UIDIndex)) ||
+				 !fits(header.firsts, header.firstCount, sizeof(int)) ||
+				 !fits(header.children, header.childCount, sizeof(int)) ||
+				 !fits(header.preconditions, header.preconditionCount, sizeof(PreconditionOp)) ||
+				 !fits(header.expressions, header.expressionCount, sizeof(ExpressionOp)) ||
+				 !fits(header.values, (unsigned long long)header.characterCount * header.slotCount, sizeof(int)) ||
+				 !fits(header.nameOffsets, header.nameOffsetCount, sizeof(unsigned int)) ||
+				 header.nameData + (unsigned long long)header.nameDataSize > size){
+			error = "has a section outside the file";
+		}
+
+		if (error.empty()){
+			const unsigned int* offsets = this->section<unsigned int>(header.stringOffsets);
+			for (unsigned int id = 0; id < header.stringCount && error.empty(); id++){
+				if (offsets[id] > offsets[id + 1] || header.stringData + (unsigned long long)offsets[id + 1] > size){
+					error = "has a string outside the file";
+				}
+			}
+		}
+
+		std::set<std::pair<int, int>> slotNames;
+		for (unsigned int slot = 0; slot < header.slotCount && error.empty(); slot++){
+			const ImageSlot& imageSlot = this->getSlot(slot);
+			if (imageSlot.clsID < 0 || imageSlot.clsID >= (int)header.stringCount ||
+				imageSlot.typeID < 0 || imageSlot.typeID >= (int)header.stringCount){
+				error = "has an SDB slot with an unknown name";
+			}
+			else if (!slotNames.insert(std::make_pair(imageSlot.clsID, imageSlot.typeID)).second){
+				error = "has two SDB slots with the same name";
+			}
+		}
+
+		//Every range and index a traversal follows has to stay inside its character's arrays
+		for (unsigned int character = 0; character < header.characterCount && error.empty(); character++){
+			const ImageCharacter& imageChar = this->getCharacter(character);
+			if (imageChar.nameID < 0 || imageChar.nameID >= (int)header.stringCount ||
+				(unsigned long long)imageChar.actionBegin + imageChar.actionCount > header.actionCount ||
+				(unsigned long long)imageChar.firstBegin + imageChar.firstCount > header.firstCount ||
+				(unsigned long long)imageChar.childBegin + imageChar.childCount > header.childCount ||
+				(unsigned long long)imageChar.preconditionBegin + imageChar.preconditionCount > header.preconditionCount ||
+				(unsigned long long)imageChar.expressionBegin + imageChar.expressionCount > header.expressionCount ||
+				(unsigned long long)imageChar.nameBegin + imageChar.nameCount + 1 > header.nameOffsetCount){
+				error = "has a character outside the image";
+				break;
+			}
+
+			CompiledTreeView view = this->getTreeView(character);
+			int actionCount = view.actionCount;
+			for (unsigned int name = 0; name < view.nameCount && error.empty(); name++){
+				if (view.nameOffsets[name] > view.nameOffsets[name + 1] || view.nameOffsets[name + 1] > header.nameDataSize){
+					error = "has an action name outside the file";
+				}
+			}
+			for (unsigned int first = 0; first < view.firstCount && error.empty(); first++){
+				if (view.firsts[first] < 0 || view.firsts[first] >= actionCount){
+					error = "has a first action outside its character";
+				}
+			}
+			for (unsigned int child = 0; child < view.childCount && error.empty(); child++){
+				if (view.children[child] < 0 || view.children[child] >= actionCount){
+					error = "has a child action outside its character";
+				}
+			}
+			for (unsigned int i = 0; i < view.preconditionCount && error.empty(); i++){
+				if (view.preconditions[i].slot < 0 || view.preconditions[i].slot >= (int)header.slotCount ||
+					view.preconditions[i].character < 0 || view.preconditions[i].character >= (int)header.stringCount){
+					error = "has a precondition outside the SDB";
+				}
+			}
+			//executeAction applies expressions as they are, so an unknown operation or one a boolean can't
+			//take has to be caught here. Unbound expressions (slot -1) are skipped there
+			for (unsigned int i = 0; i < view.expressionCount && error.empty(); i++){
+				const ExpressionOp& exp = view.expressions[i];
+				if (exp.slot >= (int)header.slotCount){
+					error = "has an expression outside the SDB";
+				}
+				else if (exp.slot >= 0 && (exp.opcode < EXP_ADD || exp.opcode > EXP_SET ||
+						 exp.character < 0 || exp.character >= (int)header.stringCount ||
+						 exp.key < 0 || exp.key >= (int)header.stringCount)){
+					error = "has an expression with an unknown operation or name";
+				}
+				else if (exp.slot >= 0 && this->getSlot(exp.slot).isBoolean != 0 && exp.opcode != EXP_SET){
+					error = "has an expression that adds to or subtracts from a boolean";
+				}
+			}
+			for (int action = 0; action < actionCount && error.empty(); action++){
+				const CompiledAction& compiled = view.actions[action];
+				if ((unsigned long long)compiled.childBegin + compiled.childCount > view.childCount ||
+					compiled.clsID < SymbolTable::NONE || compiled.clsID >= (int)view.classCount ||
+					(unsigned long long)compiled.preBegin + compiled.preCount > view.preconditionCount ||
+					(unsigned long long)compiled.expBegin + compiled.expCount > view.expressionCount ||
+					view.infos[action].nameID < SymbolTable::NONE || view.infos[action].nameID >= (int)view.nameCount ||
+					view.uids[action].index < 0 || view.uids[action].index >= actionCount ||
+					(action > 0 && view.uids[action - 1].uid >= view.uids[action].uid)){
+					error = "has an action outside its character";
+				}
+			}
+		}
+
+		//Traversals recurse into children without checking where they've been, so a tree that leads
+		//back to itself would never finish. Children and firsts are indices here, which do as uids
+		for (unsigned int character = 0; character < header.characterCount && error.empty(); character++){
+			CompiledTreeView view = this->getTreeView(character);
+			ActionTreeValidator validator;
+			for (unsigned int action = 0; action < view.actionCount; action++){
+				const CompiledAction& compiled = view.actions[action];
+				validator.addAction(action, view.children + compiled.childBegin, compiled.childCount);
+			}
+			for (unsigned int first = 0; first < view.firstCount; first++){
+				validator.addFirst(view.firsts[first]);
+			}
+			if (!validator.validate().cycles.empty()){
+				error = "has a character whose actions lead back to themselves";
+			}
+		}
+
+		if (!error.empty()){
+			std::cout << "StoryImage::open() error: " << path << " " << error << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	//The mapped file's size in bytes
+	unsigned long long StoryImage::getSize() const{
+		return this->file.getSize();
+	}
+
+}
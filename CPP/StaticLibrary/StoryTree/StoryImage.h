@@ -0,0 +1,115 @@
+//StoryImage.h
+#ifndef StoryImage_H
+#define StoryImage_H
+
+#include "stdafx.h"
+
+#include "CompiledTree.h"
+#include "MappedFile.h"
+
+#include <string>
+
+class SDB;
+class CharacterDB;
+
+namespace ST{
+
+	const unsigned int						STORY_IMAGE_MAGIC = 0x4D495453;	//"STIM"
+	const unsigned int						STORY_IMAGE_VERSION = 4;
+
+	//Offsets are from the start of the file and every section starts 8 byte aligned.
+	//Counts are in elements of the section's type
+	struct StoryImageHeader{
+		unsigned int						magic;
+		unsigned int						version;
+		unsigned int						headerSize;
+		unsigned int						stringCount;
+		unsigned int						stringOffsets;		//stringCount + 1 unsigned ints into stringData
+		unsigned int						stringData;
+		unsigned int						slotCount;
+		unsigned int						slots;				//ImageSlot
+		unsigned int						characterCount;
+		unsigned int						characters;			//ImageCharacter
+		unsigned int						actionCount;
+		unsigned int						actions;			//CompiledAction
+		unsigned int						infos;				//CompiledActionInfo, one per action
+		unsigned int						uids;				//UIDIndex, one per action
+		unsigned int						firstCount;
+		unsigned int						firsts;				//int
+		unsigned int						childCount;
+		unsigned int						children;			//int
+		unsigned int						preconditionCount;
+		unsigned int						preconditions;		//PreconditionOp
+		unsigned int						expressionCount;
+		unsigned int						expressions;		//ExpressionOp
+		unsigned int						values;				//int, slotCount per character
+		unsigned int						nameOffsetCount;
+		unsigned int						nameOffsets;		//unsigned int into nameData, nameCount + 1 per character
+		unsigned int						nameDataSize;
+		unsigned int						nameData;			//char, every character's action display names
+		unsigned int						fileSize;
+	};
+
+	//SDBSlot without the bool, so the layout is fixed
+	struct ImageSlot{
+		int									clsID;
+		int									typeID;
+		int									isBoolean;
+		int									defaultVal;
+		int									min;
+		int									max;
+	};
+
+	//Where a character's arrays start in the image's shared sections. Each character's CompiledActions
+	//index its own arrays, so a CompiledTreeView of it is just these starting points
+	struct ImageCharacter{
+		int									nameID;
+		unsigned int						actionBegin;
+		unsigned int						actionCount;
+		unsigned int						firstBegin;
+		unsigned int						firstCount;
+		unsigned int						childBegin;
+		unsigned int						childCount;
+		unsigned int						preconditionBegin;
+		unsigned int						preconditionCount;
+		unsigned int						expressionBegin;
+		unsigned int						expressionCount;
+		unsigned int						classCount;
+		unsigned int						nameBegin;
+		unsigned int						nameCount;
+	};
+
+	//A compiled world in one file: the symbol table, the SDB's slot layout, every character's starting
+	//values and every character's CompiledTree. Loading maps the file and points at it, so nothing is
+	//parsed and no per-action objects are built. Symbol ids are the writing process's; a process whose
+	//ids differ gets translated copies of the trees instead. Only a build with the same byte order can read it
+	class StoryImage
+	{
+	public:
+		StoryImage();
+		~StoryImage();
+
+		static bool							write(std::string path, const SDB& sdb, CharacterDB& characters);
+		bool								open(std::string path);
+
+		const StoryImageHeader&				getHeader() const;
+		std::string							getString(unsigned int id) const;
+		const ImageSlot&					getSlot(unsigned int slot) const;
+		const ImageCharacter&				getCharacter(unsigned int character) const;
+		CompiledTreeView					getTreeView(unsigned int character) const;
+		const int*							getValues(unsigned int character) const;
+		unsigned long long					getSize() const;
+
+	private:
+		MappedFile							file;
+		const StoryImageHeader*				header = NULL;
+
+		//private functions for open
+		template<class T>
+		const T*							section(unsigned int offset) const;
+		bool								validate(std::string path) const;
+	};
+
+}
+
+#endif
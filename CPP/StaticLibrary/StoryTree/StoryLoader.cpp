@@ -0,0 +1,646 @@
+//StoryLoader.cpp
+#include "stdafx.h"
+#include "StoryLoader.h"
+#include "JsonReader.h"
+#include "ActionTreeValidator.h"
+#include "SymbolTable.h"
+#include "SDB.h"
+#include "CharacterDB.h"
+
+#include <climits>
+#include <fstream>
+#include <sstream>
+#include <unordered_map>
+
+namespace ST{
+
+	enum JsonType {JSON_STRING, JSON_NUMBER, JSON_BOOLEAN};
+
+	//A scalar as the parser handed it over. text is only valid for the call it's passed to
+	struct JsonValue{
+		JsonType							type;
+		const std::string*					text;
+		double								number;
+		bool								boolean;
+	};
+
+	//Story files are an array of records (or a single record). This turns their events into calls naming
+	//the field each value belongs to within its record, like "uid" or "preconditions.value"
+	class RecordHandler : public JsonHandler
+	{
+	public:
+		bool startObject(){
+			SourceLocation location = { this->line, this->column };
+			if (this->frames.empty() || (this->frames.size() == 1 && this->frames[0].isArray)){
+				this->pushFrame(false);
+				return this->beginRecord(location);
+			}
+			std::string field = this->fieldPath();
+			this->pushFrame(false);
+			return this->beginNested(field, location);
+		}
+
+		bool endObject(){
+			this->frames.pop_back();
+			if (this->frames.empty() || (this->frames.size() == 1 && this->frames[0].isArray)){
+				return this->endRecord();
+			}
+			return this->endNested(this->fieldPath());
+		}
+
+		bool startArray(){
+			if (this->frames.size() >= 2 && this->frames.back().isArray){
+				return this->fail("Story files don't use arrays of arrays");
+			}
+			if (this->frames.size() == 1 && this->frames[0].isArray){
+				return this->fail("Story files hold an array of objects");
+			}
+			this->pushFrame(true);
+			return true;
+		}
+
+		bool endArray(){
+			this->frames.pop_back();
+			return true;
+		}
+
+		bool key(const std::string& name){
+			this->frames.back().key = name;
+			return true;
+		}
+
+		bool string(const std::string& value){
+			JsonValue scalar = { JSON_STRING, &value, 0, false };
+			return this->scalar(scalar);
+		}
+
+		bool number(double value){
+			JsonValue scalar = { JSON_NUMBER, NULL, value, false };
+			return this->scalar(scalar);
+		}
+
+		bool boolean(bool value){
+			JsonValue scalar = { JSON_BOOLEAN, NULL, 0, value };
+			return this->scalar(scalar);
+		}
+
+		//A null is the same as leaving the field out
+		bool null(){
+			return true;
+		}
+
+	protected:
+		virtual bool beginRecord(const SourceLocation& location) = 0;
+		virtual bool endRecord(){
+			return true;
+		}
+
+		//An object inside a record, like one of an action's preconditions
+		virtual bool beginNested(const std::string& /*field*/, const SourceLocation& /*location*/){
+			return true;
+		}
+		virtual bool endNested(const std::string& /*field*/){
+			return true;
+		}
+
+		//field is "" for a value outside any record
+		virtual bool value(const std::string& field, const JsonValue& value) = 0;
+
+		bool readString(const std::string& field, const JsonValue& value, std::string& result){
+			if (value.type != JSON_STRING){
+				return this->fail("'" + field + "' has to be a string");
+			}
+			result = *(value.text);
+			return true;
+		}
+
+		bool readInt(const std::string& field, const JsonValue& value, int& result){
+			if (value.type != JSON_NUMBER || value.number != (double)(int)value.number ||
+				value.number < INT_MIN || value.number > INT_MAX){
+				return this->fail("'" + field + "' has to be a whole number");
+			}
+			result = (int)value.number;
+			return true;
+		}
+
+		bool readBool(const std::string& field, const JsonValue& value, bool& result){
+			if (value.type != JSON_BOOLEAN){
+				return this->fail("'" + field + "' has to be true or false");
+			}
+			result = value.boolean;
+			return true;
+		}
+
+		//Fills in a characteristic, precondition or expression's value, which can be a number or a bool
+		bool readValue(const std::string& field, const JsonValue& value, ValueRecord& record){
+			if (value.type == JSON_BOOLEAN){
+				record.isBoolean = true;
+				record.value = value.boolean ? 1 : 0;
+				return true;
+			}
+			record.isBoolean = false;
+			if (!this->readInt(field, value, record.value)){
+				return this->fail("'" + field + "' has to be a whole number, true or false");
+			}
+			return true;
+		}
+
+	private:
+		struct Frame{
+			bool							isArray;
+			std::string						key;
+		};
+		std::vector<Frame>					frames;
+
+		void pushFrame(bool isArray){
+			this->frames.push_back(Frame());
+			this->frames.back().isArray = isArray;
+		}
+
+		//The keys leading from the current record to the current value
+		std::string fieldPath() const{
+			std::string path;
+			for (unsigned int i = 0; i < this->frames.size(); i++){
+				const Frame& frame = this->frames[i];
+				if (frame.isArray){
+					continue;
+				}
+				if (!path.empty()){
+					path += ".";
+				}
+				path += frame.key;
+			}
+			return path;
+		}
+
+		bool scalar(const JsonValue& value){
+			if (this->frames.empty() || (this->frames.size() == 1 && this->frames[0].isArray)){
+				return this->value("", value);
+			}
+			return this->value(this->fieldPath(), value);
+		}
+	};
+
+	class SDBHandler : public RecordHandler
+	{
+	public:
+		SDBHandler(std::vector<SDBClassRecord>& classes) : classes(classes){
+		}
+
+	protected:
+		bool beginRecord(const SourceLocation& location){
+			this->classes.push_back(SDBClassRecord());
+			SDBClassRecord& record = this->classes.back();
+			record.isBoolean = false;
+			record.defaultVal = 0;
+			record.min = 0;
+			record.max = 0;
+			record.location = location;
+			this->hasBoolean = this->hasDefault = this->hasMin = this->hasMax = false;
+			return true;
+		}
+
+		bool value(const std::string& field, const JsonValue& value){
+			if (this->classes.empty() || field.empty()){
+				return this->fail("Expected an SDB class object");
+			}
+			SDBClassRecord& record = this->classes.back();
+			if (field == "class"){
+				return this->readString(field, value, record.name);
+			}
+			else if (field == "types"){
+				record.types.push_back(std::string());
+				return this->readString(field, value, record.types.back());
+			}
+			else if (field == "isBoolean"){
+				this->hasBoolean = true;
+				return this->readBool(field, value, record.isBoolean);
+			}
+			else if (field == "min"){
+				this->hasMin = true;
+				return this->readInt(field, value, record.min);
+			}
+			else if (field == "max"){
+				this->hasMax = true;
+				return this->readInt(field, value, record.max);
+			}
+			else if (field == "defaultVal"){
+				this->hasDefault = true;
+				this->defaultValue = value;
+				return (value.type == JSON_BOOLEAN) || this->readInt(field, value, record.defaultVal);
+			}
+			return true;
+		}
+
+		//isBoolean can come after defaultVal, so the value's type is only checked once the whole class is read
+		bool endRecord(){
+			SDBClassRecord& record = this->classes.back();
+			if (record.name.empty()){
+				return this->fail("An SDB class needs a 'class' name");
+			}
+			if (!this->hasBoolean || !this->hasDefault){
+				return this->fail("The SDB class " + record.name + " needs 'isBoolean' and 'defaultVal'");
+			}
+
+			if (record.isBoolean){
+				if (this->defaultValue.type != JSON_BOOLEAN){
+					return this->fail("The SDB class " + record.name + " is boolean, so its 'defaultVal' has to be true or false");
+				}
+				record.defaultVal = this->defaultValue.boolean ? 1 : 0;
+				record.min = 0;
+				record.max = 1;
+				return true;
+			}
+
+			if (this->defaultValue.type == JSON_BOOLEAN){
+				return this->fail("The SDB class " + record.name + " isn't boolean, so its 'defaultVal' has to be a whole number");
+			}
+			if (!this->hasMin || !this->hasMax){
+				return this->fail("The SDB class " + record.name + " needs a 'min' and 'max'");
+			}
+			return true;
+		}
+
+	private:
+		std::vector<SDBClassRecord>&		classes;
+		bool								hasBoolean = false;
+		bool								hasDefault = false;
+		bool								hasMin = false;
+		bool								hasMax = false;
+		JsonValue							defaultValue;
+	};
+
+	class CharactersHandler : public RecordHandler
+	{
+	public:
+		CharactersHandler(std::vector<CharacterRecord>& characters) : characters(characters){
+		}
+
+	protected:
+		bool beginRecord(const SourceLocation& /*location*/){
+			return this->fail("Expected a name, not an object");
+		}
+
+		bool value(const std::string& /*field*/, const JsonValue& value){
+			CharacterRecord record;
+			record.location.line = this->line;
+			record.location.column = this->column;
+			if (!this->readString("character", value, record.name)){
+				return false;
+			}
+			this->characters.push_back(record);
+			return true;
+		}
+
+	private:
+		std::vector<CharacterRecord>&		characters;
+	};
+
+	class CharacteristicsHandler : public RecordHandler
+	{
+	public:
+		CharacteristicsHandler(std::vector<ValueRecord>& characteristics) : characteristics(characteristics){
+		}
+
+	protected:
+		bool beginRecord(const SourceLocation& location){
+			this->characteristics.push_back(ValueRecord());
+			this->characteristics.back().location = location;
+			this->hasValue = false;
+			return true;
+		}
+
+		bool value(const std::string& field, const JsonValue& value){
+			if (this->characteristics.empty() || field.empty()){
+				return this->fail("Expected a characteristic object");
+			}
+			ValueRecord& record = this->characteristics.back();
+			if (field == "name"){
+				return this->readString(field, value, record.character);
+			}
+			else if (field == "class"){
+				return this->readString(field, value, record.cls);
+			}
+			else if (field == "type"){
+				return this->readString(field, value, record.type);
+			}
+			else if (field == "value"){
+				this->hasValue = true;
+				return this->readValue(field, value, record);
+			}
+			return true;
+		}
+
+		bool endRecord(){
+			const ValueRecord& record = this->characteristics.back();
+			if (record.character.empty() || record.cls.empty() || record.type.empty() || !this->hasValue){
+				return this->fail("A characteristic needs a 'name', 'class', 'type' and 'value'");
+			}
+			return true;
+		}
+
+	private:
+		std::vector<ValueRecord>&			characteristics;
+		bool								hasValue = false;
+	};
+
+	class ActionsHandler : public RecordHandler
+	{
+	public:
+		ActionsHandler(std::vector<ActionRecord>& actions) : actions(actions){
+		}
+
+	protected:
+		bool beginRecord(const SourceLocation& location){
+			this->actions.push_back(ActionRecord());
+			ActionRecord& record = this->actions.back();
+			record.uid = 0;
+			record.first = false;
+			record.location = location;
+			this->hasUID = false;
+			return true;
+		}
+
+		bool endRecord(){
+			const ActionRecord& record = this->actions.back();
+			if (record.name.empty() || !this->hasUID){
+				return this->fail("An action needs a 'name' and a 'uid'");
+			}
+			return true;
+		}
+
+		bool beginNested(const std::string& field, const SourceLocation& location){
+			std::vector<ValueRecord>* list = this->getList(field);
+			if (list != NULL){
+				list->push_back(ValueRecord());
+				list->back().isBoolean = false;
+				list->back().value = 0;
+				list->back().location = location;
+				this->hasValue = false;
+			}
+			return true;
+		}
+
+		bool endNested(const std::string& field){
+			std::vector<ValueRecord>* list = this->getList(field);
+			if (list == NULL){
+				return true;
+			}
+			const ValueRecord& record = list->back();
+			if (record.character.empty() || record.cls.empty() || record.type.empty() || !this->hasValue){
+				return this->fail("Each of '" + field + "' needs a 'character', 'class', 'type' and 'value'");
+			}
+			if (!record.isBoolean && record.operation.empty()){
+				return this->fail("Each of '" + field + "' with a number needs an 'operation'");
+			}
+			return true;
+		}
+
+		bool value(const std::string& field, const JsonValue& value){
+			if (this->actions.empty() || field.empty()){
+				return this->fail("Expected an action object");
+			}
+			ActionRecord& record = this->actions.back();
+			if (field == "name"){
+				return this->readString(field, value, record.name);
+			}
+			else if (field == "uid"){
+				this->hasUID = true;
+				return this->readInt(field, value, record.uid);
+			}
+			else if (field == "first"){
+				return this->readBool(field, value, record.first);
+			}
+			else if (field == "class"){
+				return this->readString(field, value, record.cls);
+			}
+			else if (field == "leadsTo"){
+				record.children.push_back(0);
+				return this->readInt(field, value, record.children.back());
+			}
+			else if (field == "preconditions" || field == "expressions"){
+				return this->fail("'" + field + "' has to be an array of objects");
+			}
+
+			//A field of a precondition or expression
+			size_t dot = field.find('.');
+			std::vector<ValueRecord>* list = (dot == std::string::npos) ? NULL : this->getList(field.substr(0, dot));
+			if (list == NULL){
+				return true;
+			}
+			ValueRecord& valueRecord = list->back();
+			std::string name = field.substr(dot + 1);
+			if (name == "character"){
+				return this->readString(field, value, valueRecord.character);
+			}
+			else if (name == "class"){
+				return this->readString(field, value, valueRecord.cls);
+			}
+			else if (name == "type"){
+				return this->readString(field, value, valueRecord.type);
+			}
+			else if (name == "operation"){
+				return this->readString(field, value, valueRecord.operation);
+			}
+			else if (name == "value"){
+				this->hasValue = true;
+				return this->readValue(field, value, valueRecord);
+			}
+			return true;
+		}
+
+	private:
+		std::vector<ActionRecord>&			actions;
+		bool								hasUID = false;
+		bool								hasValue = false;
+
+		std::vector<ValueRecord>* getList(const std::string& field){
+			if (field == "preconditions"){
+				return &(this->actions.back().preconditions);
+			}
+			else if (field == "expressions"){
+				return &(this->actions.back().expressions);
+			}
+			return NULL;
+		}
+	};
+
+	StoryLoader::StoryLoader()
+	{
+	}
+
+
+	StoryLoader::~StoryLoader()
+	{
+	}
+
+	//SDB.json: an array of {"class", "types", "isBoolean", "defaultVal"}, with "min" and "max" for numbers
+	bool StoryLoader::readSDB(std::string path, std::vector<SDBClassRecord>& classes){
+		SDBHandler handler(classes);
+		return this->read(path, handler);
+	}
+
+	//characters.json: an array of names
+	bool StoryLoader::readCharacters(std::string path, std::vector<CharacterRecord>& characters){
+		CharactersHandler handler(characters);
+		return this->read(path, handler);
+	}
+
+	//characteristics.json: an array of {"name", "class", "type", "value"}
+	bool StoryLoader::readCharacteristics(std::string path, std::vector<ValueRecord>& characteristics){
+		CharacteristicsHandler handler(characteristics);
+		return this->read(path, handler);
+	}
+
+	//A character's story file: an array of {"name", "uid", "first", "class", "preconditions", "expressions", "leadsTo"}
+	bool StoryLoader::readActions(std::string path, std::vector<ActionRecord>& actions){
+		ActionsHandler handler(actions);
+		return this->read(path, handler);
+	}
+
+	//Classes that are already in the SDB, or listed twice, only get types added, so they can't change between
+	//boolean and number
+	bool StoryLoader::checkSDB(const std::vector<SDBClassRecord>& classes, const SDB& sdb){
+		std::unordered_map<std::string, bool> booleans;
+		for (auto& record : classes){
+			if (record.min > record.max){
+				return this->fail(record.location, "The SDB class " + record.name + "'s min is greater than its max");
+			}
+			if (record.defaultVal < record.min || record.defaultVal > record.max){
+				return this->fail(record.location, "The SDB class " + record.name + "'s defaultVal is outside its min to max range");
+			}
+
+			const SDBClass* existing = sdb.findClass(record.name);
+			auto booleanIt = booleans.find(record.name);
+			if ((existing != NULL && existing->boolean() != record.isBoolean) ||
+				(booleanIt != booleans.end() && booleanIt->second != record.isBoolean)){
+				return this->fail(record.location, "The SDB class " + record.name + " was already added with a different isBoolean");
+			}
+			booleans[record.name] = record.isBoolean;
+		}
+		return true;
+	}
+
+	bool StoryLoader::checkCharacteristics(const std::vector<ValueRecord>& characteristics, const SDB& sdb, const CharacterDB& characterDB){
+		for (auto& record : characteristics){
+			if (!this->checkValue(record, sdb, characterDB, false)){
+				return false;
+			}
+			const SDBSlot& slot = sdb.getSlotInfo(sdb.getSlot(SymbolTable::global().find(record.cls), SymbolTable::global().find(record.type)));
+			if (record.value < slot.min || record.value > slot.max){
+				return this->fail(record.location, "The value is outside " + record.cls + "'s min to max range");
+			}
+		}
+		return true;
+	}
+
+	bool StoryLoader::checkActions(const std::vector<ActionRecord>& actions, const SDB& sdb, const CharacterDB& characterDB){
+		std::unordered_map<int, const ActionRecord*> records;
+		ActionTreeValidator validator;
+		for (auto& record : actions){
+			if (!records.insert(std::make_pair(record.uid, &record)).second){
+				std::ostringstream message;
+				message << "The uid " << record.uid << " is used by more than one action";
+				return this->fail(record.location, message.str());
+			}
+			for (auto& pre : record.preconditions){
+				if (!this->checkValue(pre, sdb, characterDB, false)){
+					return false;
+				}
+			}
+			for (auto& exp : record.expressions){
+				if (!this->checkValue(exp, sdb, characterDB, true)){
+					return false;
+				}
+			}
+
+			validator.addAction(record.uid, record.children.data(), record.children.size());
+			if (record.first){
+				validator.addFirst(record.uid);
+			}
+		}
+
+		//Unreachable actions are fine, but a loop would never let a traversal finish
+		ActionTreeReport report = validator.validate();
+		if (!report.danglingChildren.empty()){
+			std::ostringstream message;
+			message << "'leadsTo' has " << report.danglingChildren[0].second << ", but there's no action with that uid";
+			return this->fail(records[report.danglingChildren[0].first]->location, message.str());
+		}
+		if (!report.cycles.empty()){
+			std::ostringstream message;
+			if (report.cycles[0].size() == 1){
+				message << "The action " << report.cycles[0][0] << " leads back to itself";
+			}
+			else {
+				message << "The actions";
+				for (auto& uid : report.cycles[0]){
+					message << " " << uid;
+				}
+				message << " lead back to each other";
+			}
+			return this->fail(records[report.cycles[0][0]]->location, message.str());
+		}
+		return true;
+	}
+
+	const std::string& StoryLoader::getError() const{
+		return this->error;
+	}
+
+	bool StoryLoader::read(std::string path, JsonHandler& handler){
+		this->path = path;
+		this->error.clear();
+
+		std::ifstream input(path, std::ios::binary);
+		if (!input){
+			this->error = path + ": Couldn't open the file";
+			return false;
+		}
+
+		JsonReader reader;
+		if (!reader.parse(input, handler)){
+			this->error = path + ": " + reader.getError();
+			return false;
+		}
+		return true;
+	}
+
+	//The character and class:type have to exist, and the value and operation have to suit the class
+	bool StoryLoader::checkValue(const ValueRecord& record, const SDB& sdb, const CharacterDB& characterDB, bool expression){
+		SymbolTable& symbols = SymbolTable::global();
+		if (characterDB.getCharacter(symbols.find(record.character)) == NULL){
+			return this->fail(record.location, "There's no character called " + record.character);
+		}
+		int slot = sdb.getSlot(symbols.find(record.cls), symbols.find(record.type));
+		if (slot < 0){
+			return this->fail(record.location, "There's no SDB class and type called " + record.cls + ":" + record.type);
+		}
+		if (sdb.getSlotInfo(slot).isBoolean != record.isBoolean){
+			return this->fail(record.location, record.cls + (record.isBoolean ? " isn't boolean, so the value has to be a whole number" :
+																				  " is boolean, so the value has to be true or false"));
+		}
+
+		const std::string& op = record.operation;
+		if (record.isBoolean){
+			if (!op.empty() && op != (expression ? "=" : "==")){
+				return this->fail(record.location, std::string("The operation on a boolean has to be '") + (expression ? "=" : "==") + "'");
+			}
+		}
+		else if (expression && op != "+" && op != "-" && op != "="){
+			return this->fail(record.location, "The operation '" + op + "' has to be '+', '-', or '='");
+		}
+		else if (!expression && !op.empty() && op != ">" && op != "<" && op != "=="){
+			return this->fail(record.location, "The operation '" + op + "' has to be '>', '<', or '=='");
+		}
+		return true;
+	}
+
+	bool StoryLoader::fail(const SourceLocation& location, std::string message){
+		std::ostringstream located;
+		located << this->path << ": line " << location.line << ", column " << location.column << ": " << message;
+		this->error = located.str();
+		return false;
+	}
+
+}
@@ -0,0 +1,99 @@
+//StoryLoader.h
+#ifndef StoryLoader_H
+#define StoryLoader_H
+
+#include "stdafx.h"
+
+#include <string>
+#include <vector>
+
+class SDB;
+class CharacterDB;
+
+namespace ST{
+
+	class JsonHandler;
+
+	//Where in a story file something was read, 1 based
+	struct SourceLocation{
+		unsigned int						line;
+		unsigned int						column;
+	};
+
+	//One entry of SDB.json. Boolean classes have a defaultVal of 0 or 1 and a range of 0 to 1
+	struct SDBClassRecord{
+		std::string							name;
+		std::vector<std::string>			types;
+		bool								isBoolean;
+		int									defaultVal;
+		int									min;
+		int									max;
+		SourceLocation						location;
+	};
+
+	//One name in characters.json
+	struct CharacterRecord{
+		std::string							name;
+		SourceLocation						location;
+	};
+
+	//A characteristic, precondition or expression: a value for one character's class:type.
+	//Characteristics have no operation
+	struct ValueRecord{
+		std::string							character;
+		std::string							cls;
+		std::string							type;
+		std::string							operation;
+		bool								isBoolean;
+		int									value;
+		SourceLocation						location;
+	};
+
+	//One entry of a character's story file
+	struct ActionRecord{
+		std::string							name;
+		int									uid;
+		bool								first;
+		std::string							cls;
+		std::vector<ValueRecord>			preconditions;
+		std::vector<ValueRecord>			expressions;
+		std::vector<int>					children;
+		SourceLocation						location;
+	};
+
+	//Reads the JS library's JSON files into records straight from the parser's events, and checks
+	//them against an SDB and CharacterDB before anything is built from them, so bad content is
+	//reported with its file, line and column instead of exiting.
+	//read and check functions never intern names, so separate StoryLoaders can run on separate threads
+	class StoryLoader
+	{
+	public:
+		StoryLoader();
+		~StoryLoader();
+
+		bool								readSDB(std::string path, std::vector<SDBClassRecord>& classes);
+		bool								readCharacters(std::string path, std::vector<CharacterRecord>& characters);
+		bool								readCharacteristics(std::string path, std::vector<ValueRecord>& characteristics);
+		bool								readActions(std::string path, std::vector<ActionRecord>& actions);
+
+		bool								checkSDB(const std::vector<SDBClassRecord>& classes, const SDB& sdb);
+		bool								checkCharacteristics(const std::vector<ValueRecord>& characteristics, const SDB& sdb, const CharacterDB& characterDB);
+		bool								checkActions(const std::vector<ActionRecord>& actions, const SDB& sdb, const CharacterDB& characterDB);
+
+		//"<path>: line 3, column 14: <what went wrong>"
+		const std::string&					getError() const;
+
+	private:
+		//The file last read, for errors
+		std::string							path;
+		std::string							error;
+
+		//private functions for reading and checking
+		bool								read(std::string path, JsonHandler& handler);
+		bool								checkValue(const ValueRecord& record, const SDB& sdb, const CharacterDB& characterDB, bool expression);
+		bool								fail(const SourceLocation& location, std::string message);
+	};
+
+}
+
+#endif
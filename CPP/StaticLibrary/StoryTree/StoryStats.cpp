@@ -0,0 +1,62 @@
+//StoryStats.cpp
+#include "stdafx.h"
+#include "StoryStats.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <chrono>
+#endif
+
+namespace ST{
+
+	void StoryStats::add(const StoryStats& other){
+		this->queries += other.queries;
+		this->nodesVisited += other.nodesVisited;
+		this->preconditionsEvaluated += other.preconditionsEvaluated;
+		this->preconditionsShortCircuited += other.preconditionsShortCircuited;
+		this->expressionsSimulated += other.expressionsSimulated;
+		this->leavesScored += other.leavesScored;
+		this->memoryEntriesTouched += other.memoryEntriesTouched;
+		this->allocations += other.allocations;
+		this->traverseUs += other.traverseUs;
+		this->rankUs += other.rankUs;
+	}
+
+#ifdef _WIN32
+	//The performance counter's ticks per microsecond. It's fixed at boot, so it's read once while the
+	//program starts, before any worker can time itself (VS2013's function statics aren't thread safe)
+	static double counterFrequency(){
+		LARGE_INTEGER frequency;
+		QueryPerformanceFrequency(&frequency);
+		return frequency.QuadPart / 1000000.0;
+	}
+
+	static const double ticksPerUs = counterFrequency();
+#endif
+
+	//Microseconds from some fixed point. VS2013's std::chrono clocks only tick about once a millisecond,
+	//so Windows uses the performance counter
+	double StoryStats::now(){
+#ifdef _WIN32
+		LARGE_INTEGER counter;
+		QueryPerformanceCounter(&counter);
+		return counter.QuadPart / ticksPerUs;
+#else
+		return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+	}
+
+	ScopedStatsTimer::ScopedStatsTimer(double& timer) : timer(timer)
+	{
+		this->start = StoryStats::now();
+	}
+
+
+	ScopedStatsTimer::~ScopedStatsTimer()
+	{
+		this->timer += StoryStats::now() - this->start;
+	}
+
+}
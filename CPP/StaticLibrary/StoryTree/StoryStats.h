@@ -0,0 +1,69 @@
+//StoryStats.h
+#ifndef StoryStats_H
+#define StoryStats_H
+
+#include "stdafx.h"
+
+//Define ST_STATS as 0 to compile the counters out of the engine; the stats calls then just return zeros.
+//The timers read the clock a few times per query, so they're off unless ST_STATS_TIMERS is defined as 1
+#ifndef ST_STATS
+#define ST_STATS 1
+#endif
+#ifndef ST_STATS_TIMERS
+#define ST_STATS_TIMERS 0
+#endif
+
+#if ST_STATS
+#define ST_STATS_ADD(stats, counter, amount)	((stats).counter += (amount))
+#define ST_STATS_GROWTH(stats, vec, extra)		((stats).allocations += ((vec).size() + (extra) > (vec).capacity()) ? 1 : 0)
+#else
+#define ST_STATS_ADD(stats, counter, amount)	((void)0)
+#define ST_STATS_GROWTH(stats, vec, extra)		((void)0)
+#endif
+
+#if ST_STATS && ST_STATS_TIMERS
+#define ST_STATS_CONCAT_(a, b)					a##b
+#define ST_STATS_CONCAT(a, b)					ST_STATS_CONCAT_(a, b)
+#define ST_STATS_TIMER(stats, timer)			ST::ScopedStatsTimer ST_STATS_CONCAT(statsTimer, __LINE__)((stats).timer)
+#else
+#define ST_STATS_TIMER(stats, timer)			((void)0)
+#endif
+
+namespace ST{
+
+	//What the engine has done for one character since its stats were last reset. Traversals count into
+	//their arena and add the total to the character's stats once the query is done, so workers never share counters
+	struct StoryStats{
+		unsigned long long							queries = 0;						//getOptions traversals, cache hits aren't counted
+		unsigned long long							nodesVisited = 0;					//times a traversal reached an action
+		unsigned long long							preconditionsEvaluated = 0;			//precondition ops run on the character's actions
+		unsigned long long							preconditionsShortCircuited = 0;	//ops skipped because an earlier one failed
+		unsigned long long							expressionsSimulated = 0;			//expressions whose change a traversal worked out
+		unsigned long long							leavesScored = 0;
+		unsigned long long							memoryEntriesTouched = 0;			//memory keys added to or scored
+		unsigned long long							allocations = 0;					//scratch buffer growths and returned paths
+		double										traverseUs = 0;						//walking the tree, scoring leaves included
+		double										rankUs = 0;							//picking the options from the leaves
+
+		void										add(const StoryStats& other);
+		static double								now();
+	};
+
+	//Adds the microseconds it lived to a StoryStats timer
+	class ScopedStatsTimer
+	{
+	public:
+		ScopedStatsTimer(double& timer);
+		~ScopedStatsTimer();
+
+	private:
+		double&										timer;
+		double										start;
+
+		ScopedStatsTimer(const ScopedStatsTimer&);
+		ScopedStatsTimer&							operator=(const ScopedStatsTimer&);
+	};
+
+}
+
+#endif
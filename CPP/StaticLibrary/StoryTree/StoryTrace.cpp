@@ -0,0 +1,422 @@
+//StoryTrace.cpp
+#include "stdafx.h"
+#include "StoryTrace.h"
+
+#include <climits>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace ST{
+
+	//Longer lists than this in a trace mean it's corrupt, not that it needs the memory
+	static const unsigned long long TRACE_MAX_COUNT = 1 << 24;
+
+	TraceWriter::TraceWriter()
+	{
+	}
+
+
+	TraceWriter::~TraceWriter()
+	{
+		this->close();
+	}
+
+	bool TraceWriter::open(std::string path, const TraceState& state){
+		this->close();
+		this->names.clear();
+		this->out.open(path.c_str(), std::ios::binary | std::ios::trunc);
+		if (!this->out){
+			std::cout << "TraceWriter::open() error: Couldn't open " << path << std::endl;
+			return false;
+		}
+
+		for (int byte = 0; byte < 4; byte++){
+			this->out.put((char)((STORY_TRACE_MAGIC >> (byte * 8)) & 0xFF));
+		}
+		this->writeNumber(STORY_TRACE_VERSION);
+
+		this->writeNumber(state.randomState.size());
+		for (auto& word : state.randomState){
+			this->writeNumber(word);
+		}
+		this->writeFloat(state.conversationType);
+		this->writeNumber(state.cacheEnabled ? 1 : 0);
+
+		this->writeNumber(state.memories.size());
+		for (auto& memory : state.memories){
+			this->writeName(memory.character);
+			this->writeSigned(memory.timeStep);
+			this->writeDouble(memory.squaredLength);
+			this->writeNumber(memory.keys.size());
+			for (unsigned int i = 0; i < memory.keys.size(); i++){
+				this->writeName(memory.keys[i]);
+				this->writeFloat(memory.values[i]);
+			}
+		}
+		return true;
+	}
+
+	void TraceWriter::write(const TraceCall& call){
+		if (!this->out.is_open()){
+			return;
+		}
+
+		this->writeNumber(call.type);
+		switch (call.type){
+		case TRACE_GET_OPTIONS:
+		case TRACE_GET_OPTIONS_BATCH:
+			if (call.type == TRACE_GET_OPTIONS_BATCH){
+				this->writeNumber(call.characters.size());
+			}
+			for (auto& character : call.characters){
+				this->writeName(character);
+			}
+			this->writeSigned(call.numOfOptions);
+			for (auto& options : call.options){
+				this->writeNumber(options.size());
+				for (auto& path : options){
+					this->writePath(path);
+				}
+			}
+			break;
+		case TRACE_EXECUTE_ACTION:
+			this->writeName(call.characters[0]);
+			this->writePath(call.path);
+			break;
+		case TRACE_SET_SEED:
+			this->writeNumber(call.seed);
+			break;
+		case TRACE_SET_CONVERSATION_TYPE:
+			this->writeFloat(call.conversationType);
+			break;
+		case TRACE_SET_CACHE_ENABLED:
+			this->writeNumber(call.enabled ? 1 : 0);
+			break;
+		}
+	}
+
+	void TraceWriter::close(){
+		if (this->out.is_open()){
+			this->writeNumber(TRACE_END);
+			this->out.close();
+		}
+	}
+
+	void TraceWriter::writeNumber(unsigned long long value){
+		while (value >= 0x80){
+			this->out.put((char)((value & 0x7F) | 0x80));
+			value >>= 7;
+		}
+		this->out.put((char)value);
+	}
+
+	//Zigzag, so small negative numbers stay short too
+	void TraceWriter::writeSigned(long long value){
+		this->writeNumber(((unsigned long long)value << 1) ^ (unsigned long long)(value >> 63));
+	}
+
+	void TraceWriter::writeFloat(float value){
+		unsigned int bits;
+		memcpy(&bits, &value, sizeof(bits));
+		for (int byte = 0; byte < 4; byte++){
+			this->out.put((char)((bits >> (byte * 8)) & 0xFF));
+		}
+	}
+
+	void TraceWriter::writeDouble(double value){
+		unsigned long long bits;
+		memcpy(&bits, &value, sizeof(bits));
+		for (int byte = 0; byte < 8; byte++){
+			this->out.put((char)((bits >> (byte * 8)) & 0xFF));
+		}
+	}
+
+	void TraceWriter::writeName(const std::string& name){
+		auto found = this->names.find(name);
+		if (found != this->names.end()){
+			this->writeNumber(found->second);
+			return;
+		}
+		unsigned int index = this->names.size();
+		this->names[name] = index;
+		this->writeNumber(index);
+		this->writeNumber(name.size());
+		this->out.write(name.data(), name.size());
+	}
+
+	void TraceWriter::writePath(const std::vector<int>& path){
+		this->writeNumber(path.size());
+		for (auto& uid : path){
+			this->writeSigned(uid);
+		}
+	}
+
+	TraceReader::TraceReader()
+	{
+	}
+
+
+	TraceReader::~TraceReader()
+	{
+	}
+
+	bool TraceReader::open(std::string path){
+		this->path = path;
+		this->names.clear();
+		this->state = TraceState();
+		this->error.clear();
+		if (this->in.is_open()){
+			this->in.close();
+		}
+		this->in.clear();
+		this->in.open(path.c_str(), std::ios::binary);
+		if (!this->in){
+			return this->fail("Couldn't open the file");
+		}
+
+		unsigned int magic = 0;
+		for (int byte = 0; byte < 4; byte++){
+			magic |= (unsigned int)(unsigned char)this->in.get() << (byte * 8);
+		}
+		unsigned int version;
+		if (!this->in || magic != STORY_TRACE_MAGIC){
+			return this->fail("This isn't a story trace");
+		}
+		if (!this->readUnsigned(version) || version != STORY_TRACE_VERSION){
+			return this->fail("The trace was written by a different version");
+		}
+
+		unsigned int count;
+		if (!this->readCount(count)){
+			return this->fail("The header is cut short");
+		}
+		this->state.randomState.resize(count);
+		for (auto& word : this->state.randomState){
+			if (!this->readUnsigned(word)){
+				return this->fail("The header is cut short");
+			}
+		}
+		unsigned int cacheEnabled;
+		if (!this->readFloat(this->state.conversationType) || !this->readUnsigned(cacheEnabled) || !this->readCount(count)){
+			return this->fail("The header is cut short");
+		}
+		this->state.cacheEnabled = (cacheEnabled != 0);
+
+		this->state.memories.resize(count);
+		for (auto& memory : this->state.memories){
+			unsigned int keyCount;
+			if (!this->readName(memory.character) || !this->readSigned(memory.timeStep) || !this->readDouble(memory.squaredLength) || !this->readCount(keyCount)){
+				return this->fail("The header is cut short");
+			}
+			memory.keys.resize(keyCount);
+			memory.values.resize(keyCount);
+			for (unsigned int i = 0; i < keyCount; i++){
+				if (!this->readName(memory.keys[i]) || !this->readFloat(memory.values[i])){
+					return this->fail("The header is cut short");
+				}
+			}
+		}
+		return true;
+	}
+
+	const TraceState& TraceReader::getState() const{
+		return this->state;
+	}
+
+	bool TraceReader::next(TraceCall& call){
+		call = TraceCall();
+		if (!this->error.empty() || !this->in.is_open()){
+			return false;
+		}
+
+		unsigned int type;
+		if (!this->readUnsigned(type)){
+			return false;
+		}
+		call.type = type;
+
+		unsigned int count = 1;
+		switch (type){
+		case TRACE_END:
+			return false;
+		//A batch is a getOptions for count characters
+		case TRACE_GET_OPTIONS_BATCH:
+			if (!this->readCount(count)){
+				return false;
+			}
+			//Falls through
+		case TRACE_GET_OPTIONS:
+			call.characters.resize(count);
+			for (auto& character : call.characters){
+				if (!this->readName(character)){
+					return false;
+				}
+			}
+			if (!this->readSigned(call.numOfOptions)){
+				return false;
+			}
+			call.options.resize(count);
+			for (auto& options : call.options){
+				unsigned int optionCount;
+				if (!this->readCount(optionCount)){
+					return false;
+				}
+				options.resize(optionCount);
+				for (auto& path : options){
+					if (!this->readPath(path)){
+						return false;
+					}
+				}
+			}
+			return true;
+		case TRACE_EXECUTE_ACTION:
+			call.characters.resize(1);
+			return this->readName(call.characters[0]) && this->readPath(call.path);
+		case TRACE_SET_SEED:
+			return this->readUnsigned(call.seed);
+		case TRACE_SET_CONVERSATION_TYPE:
+			return this->readFloat(call.conversationType);
+		case TRACE_SET_CACHE_ENABLED:{
+			unsigned int enabled;
+			if (!this->readUnsigned(enabled)){
+				return false;
+			}
+			call.enabled = (enabled != 0);
+			return true;
+		}
+		}
+
+		std::ostringstream message;
+		message << "There's no call of type " << type;
+		return this->fail(message.str());
+	}
+
+	//Empty at the end of a trace, even one cut short
+	const std::string& TraceReader::getError() const{
+		return this->error;
+	}
+
+	//Returns false at the end of the file, without an error, so a cut short trace just ends
+	bool TraceReader::readNumber(unsigned long long& value){
+		value = 0;
+		for (int shift = 0; shift < 64; shift += 7){
+			int c = this->in.get();
+			if (c == EOF){
+				return false;
+			}
+			value |= (unsigned long long)(c & 0x7F) << shift;
+			if ((c & 0x80) == 0){
+				return true;
+			}
+		}
+		return this->fail("A number is too long");
+	}
+
+	bool TraceReader::readUnsigned(unsigned int& value){
+		unsigned long long number;
+		if (!this->readNumber(number)){
+			return false;
+		}
+		if (number > 0xFFFFFFFFull){
+			return this->fail("A number is too big");
+		}
+		value = (unsigned int)number;
+		return true;
+	}
+
+	//The length of a list or name, which is then allocated
+	bool TraceReader::readCount(unsigned int& count){
+		if (!this->readUnsigned(count)){
+			return false;
+		}
+		if (count > TRACE_MAX_COUNT){
+			return this->fail("A list is too long");
+		}
+		return true;
+	}
+
+	bool TraceReader::readSigned(int& value){
+		unsigned long long number;
+		if (!this->readNumber(number)){
+			return false;
+		}
+		long long decoded = (long long)(number >> 1) ^ -(long long)(number & 1);
+		if (decoded < INT_MIN || decoded > INT_MAX){
+			return this->fail("A number is too big");
+		}
+		value = (int)decoded;
+		return true;
+	}
+
+	bool TraceReader::readFloat(float& value){
+		unsigned int bits = 0;
+		for (int byte = 0; byte < 4; byte++){
+			int c = this->in.get();
+			if (c == EOF){
+				return false;
+			}
+			bits |= (unsigned int)c << (byte * 8);
+		}
+		memcpy(&value, &bits, sizeof(value));
+		return true;
+	}
+
+	bool TraceReader::readDouble(double& value){
+		unsigned long long bits = 0;
+		for (int byte = 0; byte < 8; byte++){
+			int c = this->in.get();
+			if (c == EOF){
+				return false;
+			}
+			bits |= (unsigned long long)c << (byte * 8);
+		}
+		memcpy(&value, &bits, sizeof(value));
+		return true;
+	}
+
+	bool TraceReader::readName(std::string& name){
+		unsigned int index;
+		if (!this->readUnsigned(index)){
+			return false;
+		}
+		if (index < this->names.size()){
+			name = this->names[index];
+			return true;
+		}
+		if (index != this->names.size()){
+			return this->fail("A name is used before it's given");
+		}
+
+		unsigned int length;
+		if (!this->readCount(length)){
+			return false;
+		}
+		name.resize(length);
+		if (length > 0 && !this->in.read(&name[0], length)){
+			return false;
+		}
+		this->names.push_back(name);
+		return true;
+	}
+
+	bool TraceReader::readPath(std::vector<int>& path){
+		unsigned int length;
+		if (!this->readCount(length)){
+			return false;
+		}
+		path.resize(length);
+		for (auto& uid : path){
+			if (!this->readSigned(uid)){
+				return false;
+			}
+		}
+		return true;
+	}
+
+	bool TraceReader::fail(std::string message){
+		this->error = this->path + ": " + message;
+		return false;
+	}
+
+}
@@ -0,0 +1,120 @@
+//StoryTrace.h
+#ifndef StoryTrace_H
+#define StoryTrace_H
+
+#include "stdafx.h"
+
+#include <fstream>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace ST{
+
+	const unsigned int						STORY_TRACE_MAGIC = 0x52545453;	//"STTR"
+	const unsigned int						STORY_TRACE_VERSION = 1;
+
+	enum TraceCallType{
+		TRACE_END = 0,
+		TRACE_GET_OPTIONS = 1,
+		TRACE_GET_OPTIONS_BATCH = 2,
+		TRACE_EXECUTE_ACTION = 3,
+		TRACE_SET_SEED = 4,
+		TRACE_SET_CONVERSATION_TYPE = 5,
+		TRACE_SET_CACHE_ENABLED = 6
+	};
+
+	//One recorded StoryTree call. getOptions and executeAction have one character, getOptionsBatch
+	//has the batch's. options holds what each character got, so a replay can tell if it gets the same
+	struct TraceCall{
+		int									type = TRACE_END;
+		std::vector<std::string>			characters;
+		int									numOfOptions = 0;
+		std::vector<int>					path;
+		std::vector<std::vector<std::vector<int>>>	options;
+		unsigned int						seed = 0;
+		float								conversationType = 0;
+		bool								enabled = false;
+	};
+
+	//The part of a character's MemoryBank getOptions reads
+	struct TraceMemory{
+		std::string							character;
+		int									timeStep = 0;
+		double								squaredLength = 0;
+		std::vector<std::string>			keys;
+		std::vector<float>					values;
+	};
+
+	//What a StoryTree's answers depend on besides its content and values, as it was when tracing started.
+	//randomState is the generator as std::mt19937 streams it, so it only means the same thing to the
+	//same standard library
+	struct TraceState{
+		std::vector<unsigned int>			randomState;
+		float								conversationType = 0.5f;
+		bool								cacheEnabled = true;
+		std::vector<TraceMemory>			memories;
+	};
+
+	//Writes a trace: a header with the TraceState, then one record per call. Numbers are LEB128 varints
+	//(signed ones zigzagged), floats are their bits, and a name is its index in the order names first
+	//appeared, followed by the name itself the first time
+	class TraceWriter
+	{
+	public:
+		TraceWriter();
+		~TraceWriter();
+
+		bool								open(std::string path, const TraceState& state);
+		void								write(const TraceCall& call);
+		void								close();
+
+	private:
+		std::ofstream						out;
+		std::unordered_map<std::string, unsigned int>	names;
+
+		//private functions for writing
+		void								writeNumber(unsigned long long value);
+		void								writeSigned(long long value);
+		void								writeFloat(float value);
+		void								writeDouble(double value);
+		void								writeName(const std::string& name);
+		void								writePath(const std::vector<int>& path);
+	};
+
+	//Reads a trace back. A trace whose writer never closed it ends at its last whole record
+	class TraceReader
+	{
+	public:
+		TraceReader();
+		~TraceReader();
+
+		bool								open(std::string path);
+		const TraceState&					getState() const;
+
+		//Returns false at the end of the trace, or on an error, which getError then describes
+		bool								next(TraceCall& call);
+		const std::string&					getError() const;
+
+	private:
+		std::ifstream						in;
+		std::string							path;
+		std::vector<std::string>			names;
+		TraceState							state;
+		std::string							error;
+
+		//private functions for reading
+		bool								readNumber(unsigned long long& value);
+		bool								readUnsigned(unsigned int& value);
+		bool								readCount(unsigned int& count);
+		bool								readSigned(int& value);
+		bool								readFloat(float& value);
+		bool								readDouble(double& value);
+		bool								readName(std::string& name);
+		bool								readPath(std::vector<int>& path);
+		bool								fail(std::string message);
+	};
+
+}
+
+#endif
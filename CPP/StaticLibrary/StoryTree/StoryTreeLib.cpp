@@ -1,5 +1,5 @@
 // StoryTreeLib.cpp
-// compile with: cl /c /EHsc StoryTreeLib.cpp 
+// compile with: cl /c /EHsc StoryTreeLib.cpp
 // post-build command: lib StoryTreeLib.obj
 
 #include "stdafx.h"
@@ -7,8 +7,14 @@
 #include "StoryTreeLib.h"
 #include "SDB.h"
 #include "CharacterDB.h"
+#include "StoryLoader.h"
 
 #include <stdexcept>
+#include <thread>
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <math.h>
 
 namespace ST
 {
@@ -16,4 +22,1121 @@ namespace ST
 		mySDB = new SDB();
 		characterDB = new CharacterDB();
 	}
-}
\ No newline at end of file
+
+	StoryTree::~StoryTree(){
+		delete mySDB;
+		delete characterDB;
+		delete pool;
+		delete image;
+		delete trace;
+		delete timeline;
+	}
+
+	void StoryTree::addSDBClass(const SDBClass& cls){
+		this->mySDB->addClass(cls);
+		this->characterDB->bindSDB(this->mySDB);
+		this->preconditionsStale = true;
+	}
+
+	void StoryTree::addCharacter(std::string name){
+		this->characterDB->addCharacter(name);
+		this->characterDB->getCharacter(name)->bindSDB(this->mySDB);
+		this->applyRetention(*(this->characterDB->getCharacter(name)));
+		this->preconditionsStale = true;
+	}
+
+	void StoryTree::addCharacteristic(const Characteristic& characteristic){
+		Character* myChar = this->characterDB->getCharacter(characteristic.getCharacter());
+		if (myChar == NULL){
+			std::cout << "addCharacteristic() error: There's no character with the name " << characteristic.getCharacter() << std::endl;
+			return;
+		}
+		myChar->addCharacteristic(characteristic);
+		this->preconditionsStale = true;
+	}
+
+	//Actions should be added after the SDB classes they refer to, so their slots can be resolved
+	void StoryTree::addAction(std::string character, const Action& action){
+		Character* myChar = this->characterDB->getCharacter(character);
+		if (myChar == NULL){
+			std::cout << "addAction() error: There's no character with the name " << character << std::endl;
+			return;
+		}
+
+		if (myChar->getCompiledTree().isMapped()){
+			std::cout << "addAction() error: " << character << " was loaded from a story image, so its actions can't change" << std::endl;
+			return;
+		}
+
+		Action myAction = action;
+		myAction.bindSlots(*(this->mySDB));
+		myAction.compilePreconditions();
+		myChar->addAction(myAction.getUID(), myAction);
+		this->preconditionsStale = true;
+	}
+
+	//The load functions read the JS library's JSON files. Each checks its whole file against what's already
+	//loaded before adding anything, so on an error it prints where and returns false with nothing changed.
+	//Load the SDB, then characters, then characteristics and actions
+	bool StoryTree::loadSDB(std::string path){
+		TimelineScope scope(this->timeline, "loadSDB");
+		StoryLoader loader;
+		std::vector<SDBClassRecord> classes;
+		if (!loader.readSDB(path, classes) || !loader.checkSDB(classes, *(this->mySDB))){
+			std::cout << "loadSDB() error: " << loader.getError() << std::endl;
+			return false;
+		}
+
+		for (auto& record : classes){
+			//Like the JS library, a class that's already there just gets the new types
+			const SDBClass* existing = this->mySDB->findClass(record.name);
+			if (existing != NULL){
+				SDBClass cls = *existing;
+				cls.addTypes(record.types);
+				this->addSDBClass(cls);
+			}
+			else if (record.isBoolean){
+				this->addSDBClass(SDBClass(record.name, record.types, record.defaultVal != 0));
+			}
+			else {
+				this->addSDBClass(SDBClass(record.name, record.types, record.defaultVal, record.min, record.max));
+			}
+		}
+		return true;
+	}
+
+	bool StoryTree::loadCharacters(std::string path){
+		TimelineScope scope(this->timeline, "loadCharacters");
+		StoryLoader loader;
+		std::vector<CharacterRecord> characters;
+		if (!loader.readCharacters(path, characters)){
+			std::cout << "loadCharacters() error: " << loader.getError() << std::endl;
+			return false;
+		}
+
+		for (auto& record : characters){
+			if (this->characterDB->getCharacter(record.name) != NULL){
+				std::cout << "Warning: The character " << record.name << " has already been added. Skipping it." << std::endl;
+				continue;
+			}
+			this->addCharacter(record.name);
+		}
+		return true;
+	}
+
+	bool StoryTree::loadCharacteristics(std::string path){
+		TimelineScope scope(this->timeline, "loadCharacteristics");
+		StoryLoader loader;
+		std::vector<ValueRecord> characteristics;
+		if (!loader.readCharacteristics(path, characteristics) ||
+			!loader.checkCharacteristics(characteristics, *(this->mySDB), *(this->characterDB))){
+			std::cout << "loadCharacteristics() error: " << loader.getError() << std::endl;
+			return false;
+		}
+
+		for (auto& record : characteristics){
+			if (record.isBoolean){
+				this->addCharacteristic(Characteristic(record.character, record.cls, record.type, record.value != 0));
+			}
+			else {
+				this->addCharacteristic(Characteristic(record.character, record.cls, record.type, record.value));
+			}
+		}
+		return true;
+	}
+
+	bool StoryTree::loadActions(std::string character, std::string path){
+		return this->loadActions(std::vector<std::string>(1, character), std::vector<std::string>(1, path));
+	}
+
+	//paths[i] is characters[i]'s story file. The files are read and checked in parallel on the thread pool,
+	//then their actions are added in order on this thread, so names are interned in the same order every time
+	bool StoryTree::loadActions(const std::vector<std::string>& characters, const std::vector<std::string>& paths){
+		TimelineScope scope(this->timeline, "loadActions");
+		if (characters.size() != paths.size()){
+			std::cout << "loadActions() error: There are " << characters.size() << " characters but " << paths.size() << " paths" << std::endl;
+			return false;
+		}
+		for (auto& character : characters){
+			if (this->characterDB->getCharacter(character) == NULL){
+				std::cout << "loadActions() error: There's no character with the name " << character << std::endl;
+				return false;
+			}
+		}
+
+		std::vector<std::vector<ActionRecord>> files(paths.size());
+		std::vector<std::string> errors(paths.size());
+		this->getPool().parallelFor(paths.size(), [&](unsigned int file, unsigned int /*worker*/){
+			TimelineScope fileScope(this->timeline, "readActions", this->getTimelineCharacter(characters[file]));
+			StoryLoader loader;
+			if (!loader.readActions(paths[file], files[file]) ||
+				!loader.checkActions(files[file], *(this->mySDB), *(this->characterDB))){
+				errors[file] = loader.getError();
+			}
+		});
+
+		bool loaded = true;
+		for (auto& error : errors){
+			if (!error.empty()){
+				std::cout << "loadActions() error: " << error << std::endl;
+				loaded = false;
+			}
+		}
+		if (!loaded){
+			return false;
+		}
+
+		for (unsigned int file = 0; file < files.size(); file++){
+			for (auto& record : files[file]){
+				Action action(record.name, record.uid, record.first, record.cls);
+				for (auto& pre : record.preconditions){
+					if (pre.isBoolean){
+						action.addPrecondition(Precondition(pre.character, pre.cls, pre.type, pre.value != 0));
+					}
+					else {
+						action.addPrecondition(Precondition(pre.character, pre.cls, pre.type, pre.operation, pre.value));
+					}
+				}
+				for (auto& exp : record.expressions){
+					if (exp.isBoolean){
+						action.addExpression(Expression(exp.character, exp.cls, exp.type, exp.value != 0));
+					}
+					else {
+						action.addExpression(Expression(exp.character, exp.cls, exp.type, exp.operation, exp.value));
+					}
+				}
+				for (auto& child : record.children){
+					action.addChild(child);
+				}
+				this->addAction(characters[file], action);
+			}
+		}
+		return true;
+	}
+
+	//Prints every cycle, missing child or first and duplicate uid in the character's actions, and warns
+	//about actions that can never come up. Returns false if there was anything but unreachable actions
+	bool StoryTree::validateActions(std::string character){
+		TimelineScope scope(this->timeline, "validateActions", this->getTimelineCharacter(character));
+		Character* myChar = this->characterDB->getCharacter(character);
+		if (myChar == NULL){
+			std::cout << "validateActions() error: There's no character with the name " << character << std::endl;
+			return false;
+		}
+
+		//A character loaded from a story image has no ActionTree, so check what was compiled into it
+		ActionTreeReport report;
+		const CompiledTree& tree = myChar->getCompiledTree();
+		if (tree.isMapped()){
+			ActionTreeValidator validator;
+			std::vector<int> children;
+			for (unsigned int node = 0; node < tree.size(); node++){
+				const CompiledAction& action = tree.getAction(node);
+				children.clear();
+				for (unsigned int child = 0; child < action.childCount; child++){
+					children.push_back(tree.getUID(tree.getChildren(action)[child]));
+				}
+				validator.addAction(tree.getUID(node), children.data(), children.size());
+			}
+			for (unsigned int first = 0; first < tree.getFirstCount(); first++){
+				validator.addFirst(tree.getUID(tree.getFirsts()[first]));
+			}
+			report = validator.validate();
+		}
+		else {
+			report = myChar->getActionTree().validate();
+		}
+
+		for (auto& cycle : report.cycles){
+			if (cycle.size() == 1){
+				std::cout << "validateActions() error: " << character << "'s action " << cycle[0] << " leads back to itself" << std::endl;
+				continue;
+			}
+			std::cout << "validateActions() error: " << character << "'s actions";
+			for (auto& uid : cycle){
+				std::cout << " " << uid;
+			}
+			std::cout << " lead back to each other" << std::endl;
+		}
+		for (auto& dangling : report.danglingChildren){
+			std::cout << "validateActions() error: " << character << "'s action " << dangling.first
+					  << " leads to " << dangling.second << ", which doesn't exist" << std::endl;
+		}
+		for (auto& first : report.danglingFirsts){
+			std::cout << "validateActions() error: " << character << "'s first action " << first << " doesn't exist" << std::endl;
+		}
+		for (auto& uid : report.duplicates){
+			std::cout << "validateActions() error: " << character << " has more than one action with the uid " << uid << std::endl;
+		}
+		for (auto& uid : report.unreachable){
+			std::cout << "Warning: No first action of " << character << "'s leads to " << uid << std::endl;
+		}
+		return report.isValid();
+	}
+
+	//Pruning leaves out actions that can never pass and preconditions their parents already guarantee,
+	//judging by the range of values each SDB slot can hold. It never changes getOptions' results
+	void StoryTree::setPruningEnabled(bool enabled){
+		this->pruningEnabled = enabled;
+		this->preconditionsStale = true;
+	}
+
+	//What pruning left out of the character's tree. Characters loaded from a story image were pruned, if
+	//at all, before the image was saved, so they report nothing
+	PruneReport StoryTree::getPruneReport(std::string character){
+		Character* myChar = this->characterDB->getCharacter(character);
+		if (myChar == NULL){
+			std::cout << "getPruneReport() error: There's no character with the name " << character << std::endl;
+			return PruneReport();
+		}
+		this->refreshPreconditions();
+		return myChar->getPruneReport();
+	}
+
+	void StoryTree::setConversationType(float conversationType){
+		this->conversationType = conversationType;
+		if (this->trace != NULL){
+			TraceCall call;
+			call.type = TRACE_SET_CONVERSATION_TYPE;
+			call.conversationType = conversationType;
+			this->trace->write(call);
+		}
+	}
+
+	void StoryTree::setSeed(unsigned int seed){
+		this->rng.seed(seed);
+		this->preconditionsStale = true;
+		if (this->trace != NULL){
+			TraceCall call;
+			call.type = TRACE_SET_SEED;
+			call.seed = seed;
+			this->trace->write(call);
+		}
+	}
+
+	//Caps how many memories each character holds. Older ones are already summed into the character's
+	//total memory vector, so options don't change; with a spillDirectory they're also written to
+	//<spillDirectory>/<character>.mem
+	void StoryTree::setMemoryRetention(unsigned int maxMemories, std::string spillDirectory){
+		this->maxMemories = maxMemories;
+		this->spillDirectory = spillDirectory;
+		for (auto& name : this->characterDB->getListOfCharacters()){
+			this->applyRetention(*(this->characterDB->getCharacter(name)));
+		}
+	}
+
+	//Everything getOptions does once it has the character. Only arena and rng are written to,
+	//so calls with different arenas and generators can run at the same time, as long as they
+	//don't split (split traversals use the pool and workerArenas).
+	//Only this file calls it, with a std::mt19937 or, for batches, a cheaper std::minstd_rand
+	template<class Generator>
+	std::vector<std::vector<int>> StoryTree::findOptions(const Character& myChar, int numOfOptions, TraversalArena& arena, Generator& rng, bool split){
+		std::vector<std::vector<int>> options;
+		const CompiledTree& tree = myChar.getCompiledTree();
+
+		//Traverse from each first action, collecting every reachable leaf into the arena
+		arena.reset();
+		arena.resetNodes(tree.size());
+		ST_STATS_ADD(arena.getStats(), queries, 1);
+		{
+			TimelineScope scope(this->timeline, "traverse");
+			ST_STATS_TIMER(arena.getStats(), traverseUs);
+			if (split && this->splitThreshold != 0 && tree.size() >= this->splitThreshold && this->getPool().getThreadCount() > 1){
+				this->traverseParallel(myChar, tree, arena);
+			}
+			else {
+				for (unsigned int first = 0; first < tree.getFirstCount(); first++){
+					arena.frame(0).clear();
+					this->traverse(myChar, tree, tree.getFirsts()[first], 0, SymbolTable::NONE, arena);
+				}
+			}
+		}
+
+		//Rank the leaves by salience. Every leaf draws a random tie break so equal paths take turns,
+		//and the ranking is a heap, since only the first few distinct classes are ever taken
+		TimelineScope scope(this->timeline, "rank");
+		ST_STATS_TIMER(arena.getStats(), rankUs);
+		std::vector<unsigned int>& order = arena.getOrder();
+		std::vector<unsigned int>& tieBreaks = arena.getTieBreaks();
+		ST_STATS_GROWTH(arena.getStats(), order, arena.getLeafCount());
+		ST_STATS_GROWTH(arena.getStats(), tieBreaks, arena.getLeafCount());
+		for (unsigned int i = 0; i < arena.getLeafCount(); i++){
+			order.push_back(i);
+			tieBreaks.push_back(rng());
+		}
+		auto further = [&arena, &tieBreaks](unsigned int a, unsigned int b){
+			if (arena.getLeafDist(a) != arena.getLeafDist(b)){
+				return arena.getLeafDist(a) > arena.getLeafDist(b);
+			}
+			if (tieBreaks[a] != tieBreaks[b]){
+				return tieBreaks[a] > tieBreaks[b];
+			}
+			return a > b;
+		};
+		std::make_heap(order.begin(), order.end(), further);
+
+		//Take the closest paths, skipping any whose class has already been offered. usedClasses is
+		//all clear between queries, so only the bits set here are cleared again afterwards
+		std::vector<bool>& usedClasses = arena.getUsedClasses();
+		std::vector<int>& offeredClasses = arena.getOfferedClasses();
+		if (usedClasses.size() < tree.getClassCount()){
+			usedClasses.resize(tree.getClassCount(), false);
+		}
+		while (!order.empty() && (int)options.size() < numOfOptions){
+			std::pop_heap(order.begin(), order.end(), further);
+			unsigned int leaf = order.back();
+			order.pop_back();
+
+			int cls = arena.getLeafClass(leaf);
+			if (cls != SymbolTable::NONE){
+				if (usedClasses[cls]){
+					continue;
+				}
+				usedClasses[cls] = true;
+				ST_STATS_GROWTH(arena.getStats(), offeredClasses, 1);
+				offeredClasses.push_back(cls);
+			}
+			options.push_back(arena.getLeafPath(leaf));
+		}
+		for (auto& cls : offeredClasses){
+			usedClasses[cls] = false;
+		}
+
+		ST_STATS_ADD(arena.getStats(), allocations, options.size() + 1);
+		return options;
+	}
+
+	std::vector<std::vector<int>> StoryTree::getOptions(std::string character, int numOfOptions){
+		std::vector<std::vector<int>> options = this->lookupOptions(character, numOfOptions);
+		if (this->trace != NULL){
+			TraceCall call;
+			call.type = TRACE_GET_OPTIONS;
+			call.characters.push_back(character);
+			call.numOfOptions = numOfOptions;
+			call.options.push_back(options);
+			this->trace->write(call);
+		}
+		return options;
+	}
+
+	std::vector<std::vector<int>> StoryTree::lookupOptions(std::string character, int numOfOptions){
+		TimelineScope scope(this->timeline, "getOptions", this->getTimelineCharacter(character));
+		Character* myChar = this->characterDB->getCharacter(character);
+		if (myChar == NULL){
+			std::cout << "getOptions() error: There's no character with the name " << character << std::endl;
+			return std::vector<std::vector<int>>();
+		}
+
+		this->refreshPreconditions();
+
+		//Asking again before anything the answer depends on has changed gives the same answer
+		int owner = SymbolTable::global().find(character);
+		unsigned int memoryVersion = myChar->getMemoryBank().getVersion();
+		std::vector<std::vector<int>> options;
+		if (this->cacheEnabled && this->optionCache.lookup(owner, numOfOptions, this->conversationType, memoryVersion, *(this->characterDB), options)){
+			return options;
+		}
+
+		options = this->findOptions(*myChar, numOfOptions, this->arena, this->rng, true);
+#if ST_STATS
+		myChar->getStats().add(this->arena.getStats());
+#endif
+		if (this->cacheEnabled){
+			this->optionCache.store(owner, numOfOptions, this->conversationType, memoryVersion, *(this->characterDB), options);
+		}
+		return options;
+	}
+
+	//Finds options for every character at once, spread over the thread pool. Each worker has its own
+	//arena, and each character's ties are broken by a generator seeded from this tree's generator and
+	//the character's position, so the result doesn't depend on how many threads ran it.
+	//Nothing may change the tree while a batch runs
+	OptionBatch StoryTree::getOptionsBatch(const std::vector<std::string>& characters, int numOfOptions){
+		TimelineScope scope(this->timeline, "getOptionsBatch");
+		std::vector<Character*> myChars(characters.size(), NULL);
+		for (unsigned int i = 0; i < characters.size(); i++){
+			myChars[i] = this->characterDB->getCharacter(characters[i]);
+			if (myChars[i] == NULL){
+				std::cout << "getOptionsBatch() error: There's no character with the name " << characters[i] << std::endl;
+			}
+		}
+
+		this->refreshPreconditions();
+		ThreadPool& pool = this->getPool();
+		unsigned int batchSeed = this->rng();
+		std::vector<std::vector<std::vector<int>>> results(characters.size());
+#if ST_STATS
+		std::vector<StoryStats> stats(characters.size());
+#endif
+		pool.parallelFor(characters.size(), [&](unsigned int i, unsigned int worker){
+			if (myChars[i] == NULL){
+				return;
+			}
+			TimelineScope characterScope(this->timeline, "getOptions", this->getTimelineCharacter(characters[i]));
+			//Seeding a std::mt19937 per character costs more than a small traversal
+			std::minstd_rand characterRng(batchSeed + i * 2654435761u);
+			results[i] = this->findOptions(*(myChars[i]), numOfOptions, this->workerArenas[worker], characterRng, false);
+#if ST_STATS
+			stats[i] = this->workerArenas[worker].getStats();
+#endif
+		});
+
+		//A character can be in the batch twice, so workers don't add to its stats themselves
+#if ST_STATS
+		for (unsigned int i = 0; i < characters.size(); i++){
+			if (myChars[i] != NULL){
+				myChars[i]->getStats().add(stats[i]);
+			}
+		}
+#endif
+
+		OptionBatch batch;
+		for (auto& options : results){
+			batch.addCharacter(options);
+		}
+
+		if (this->trace != NULL){
+			TraceCall call;
+			call.type = TRACE_GET_OPTIONS_BATCH;
+			call.characters = characters;
+			call.numOfOptions = numOfOptions;
+			call.options.swap(results);
+			this->trace->write(call);
+		}
+		return batch;
+	}
+
+	//0 uses one thread per core
+	void StoryTree::setThreadCount(unsigned int threadCount){
+		if (threadCount == 0){
+			threadCount = std::max(1u, std::thread::hardware_concurrency());
+		}
+		delete this->pool;
+		this->pool = new ThreadPool(threadCount);
+		if (this->workerArenas.size() < threadCount){
+			this->workerArenas.resize(threadCount);
+		}
+	}
+
+	//getOptions splits the traversal of action trees with at least this many actions across the
+	//thread pool. 0 never splits
+	void StoryTree::setSplitThreshold(unsigned int actions){
+		this->splitThreshold = actions;
+	}
+
+	//Returns "" if the action has no name, or there's no such action
+	std::string StoryTree::getActionName(std::string character, int uid){
+		Character* myChar = this->characterDB->getCharacter(character);
+		if (myChar == NULL){
+			std::cout << "getActionName() error: There's no character with the name " << character << std::endl;
+			return "";
+		}
+
+		this->refreshPreconditions();
+		const CompiledTree& tree = myChar->getCompiledTree();
+		int node = tree.getIndex(uid);
+		if (node < 0){
+			std::cout << "getActionName() error: There's no uid with the number " << uid << std::endl;
+			return "";
+		}
+		return tree.getName(node);
+	}
+
+	void StoryTree::executeAction(std::string character, std::vector<int> uidPath){
+		if (this->trace != NULL){
+			TraceCall call;
+			call.type = TRACE_EXECUTE_ACTION;
+			call.characters.push_back(character);
+			call.path = uidPath;
+			this->trace->write(call);
+		}
+
+		Character* myChar = this->characterDB->getCharacter(character);
+		if (myChar == NULL){
+			std::cout << "executeAction() error: There's no character with the name " << character << std::endl;
+			return;
+		}
+		TimelineScope scope(this->timeline, "executeAction", this->getTimelineCharacter(character));
+
+		//Check the whole path before changing any state
+		this->refreshPreconditions();
+		const CompiledTree& tree = myChar->getCompiledTree();
+		std::vector<int> nodes;
+		for (auto& uid : uidPath){
+			int node = tree.getIndex(uid);
+			if (node < 0){
+				std::cout << "executeAction() error: There's no uid with the number " << uid << std::endl;
+				return;
+			}
+			nodes.push_back(node);
+		}
+
+		Memory memory;
+		memory.encodeActions(uidPath);
+
+		for (auto& node : nodes){
+			const CompiledAction& action = tree.getAction(node);
+			const ExpressionOp* expressions = tree.getExpressions(action);
+			for (unsigned int i = 0; i < action.expCount; i++){
+				const ExpressionOp& exp = expressions[i];
+				Character* target = this->characterDB->getCharacter(exp.character);
+				if (target == NULL || exp.slot < 0){
+					continue;
+				}
+
+				//Encode the change into the memory before we make it
+				int value = target->getValue(exp.slot);
+				float change;
+				if (Memory::getChange(exp, value, this->mySDB->getSlotInfo(exp.slot), change)){
+					memory.addVecValue(exp.key, change);
+				}
+
+				target->applyExpression(exp.slot, exp.opcode, exp.operand);
+
+				if (target->getValue(exp.slot) != value){
+					this->reevaluateDependents(exp.character, exp.slot);
+				}
+			}
+		}
+
+		TimelineScope memoryScope(this->timeline, "MemoryBank::addMemory", this->getTimelineCharacter(character));
+		myChar->getMemoryBank().addMemory(memory);
+	}
+
+	//Records every getOptions, getOptionsBatch and executeAction call, and the settings calls that change
+	//their results, to tracePath until stopTrace. The trace starts with everything the calls depend on
+	//that a story image doesn't hold: the random generator, settings and memory banks. With an imagePath
+	//the image is saved first, so the pair can be replayed: load the image, call restoreTraceState with
+	//the trace's state, then make the calls. Starting a trace empties the option cache, as loading does,
+	//so a replay hits and misses the cache in the same places
+	bool StoryTree::startTrace(std::string tracePath, std::string imagePath){
+		this->stopTrace();
+		if (!imagePath.empty() && !this->saveImage(imagePath)){
+			return false;
+		}
+
+		TraceState state;
+		std::ostringstream random;
+		random << this->rng;
+		std::istringstream words(random.str());
+		unsigned int word;
+		while (words >> word){
+			state.randomState.push_back(word);
+		}
+		state.conversationType = this->conversationType;
+		state.cacheEnabled = this->cacheEnabled;
+
+		SymbolTable& symbols = SymbolTable::global();
+		for (auto& name : this->characterDB->getListOfCharacters()){
+			const MemoryBank& memBank = this->characterDB->getCharacter(name)->getMemoryBank();
+			TraceMemory memory;
+			memory.character = name;
+			memory.timeStep = memBank.getTimeStep();
+			memory.squaredLength = memBank.getExactSquaredLength();
+			const Memory& total = memBank.getTotalMemVec();
+			for (unsigned int i = 0; i < total.getKeys().size(); i++){
+				memory.keys.push_back(symbols.getName(total.getKeys()[i]));
+				memory.values.push_back(total.getValues()[i]);
+			}
+			state.memories.push_back(memory);
+		}
+
+		TraceWriter* writer = new TraceWriter();
+		if (!writer->open(tracePath, state)){
+			delete writer;
+			return false;
+		}
+		this->trace = writer;
+		this->preconditionsStale = true;
+		return true;
+	}
+
+	void StoryTree::stopTrace(){
+		delete this->trace;
+		this->trace = NULL;
+	}
+
+	//Puts the generator, settings and memory banks back as a trace started with them. The characters
+	//have to exist already, normally by loading the image saved with the trace
+	bool StoryTree::restoreTraceState(const TraceState& state){
+		std::ostringstream words;
+		for (auto& word : state.randomState){
+			words << word << " ";
+		}
+		std::istringstream random(words.str());
+		std::mt19937 restored;
+		if (!(random >> restored)){
+			std::cout << "restoreTraceState() error: The trace's random generator state can't be read by this build" << std::endl;
+			return false;
+		}
+
+		for (auto& memory : state.memories){
+			if (this->characterDB->getCharacter(memory.character) == NULL){
+				std::cout << "restoreTraceState() error: There's no character with the name " << memory.character << std::endl;
+				return false;
+			}
+		}
+
+		SymbolTable& symbols = SymbolTable::global();
+		for (auto& memory : state.memories){
+			Memory total;
+			for (unsigned int i = 0; i < memory.keys.size(); i++){
+				total.encodeVecValue(symbols.intern(memory.keys[i]), memory.values[i]);
+			}
+			this->characterDB->getCharacter(memory.character)->getMemoryBank().restore(memory.timeStep, total, memory.squaredLength);
+		}
+
+		this->rng = restored;
+		this->conversationType = state.conversationType;
+		this->cacheEnabled = state.cacheEnabled;
+		this->optionCache.clear();
+		this->preconditionsStale = true;
+		return true;
+	}
+
+	//Starts recording how long loading, validating, getOptions' phases and executeAction take on every
+	//thread, with the character each was for, dropping anything recorded since the last startTimeline
+	void StoryTree::startTimeline(){
+		if (this->timeline == NULL){
+			this->timeline = new Timeline();
+		}
+		this->timeline->clear();
+	}
+
+	//Writes what was recorded to path as a Chrome JSON trace and stops recording
+	bool StoryTree::stopTimeline(std::string path){
+		if (this->timeline == NULL){
+			std::cout << "stopTimeline() error: There's no timeline running" << std::endl;
+			return false;
+		}
+		bool written = this->timeline->write(path);
+		delete this->timeline;
+		this->timeline = NULL;
+		return written;
+	}
+
+	//The id a timeline event names character by, only looked up while there's a timeline
+	int StoryTree::getTimelineCharacter(const std::string& character) const{
+		if (this->timeline == NULL){
+			return SymbolTable::NONE;
+		}
+		return SymbolTable::global().find(character);
+	}
+
+	void StoryTree::applyRetention(Character& character){
+		std::string spillPath;
+		if (!this->spillDirectory.empty()){
+			spillPath = this->spillDirectory + "/" + character.getName() + ".mem";
+		}
+		character.getMemoryBank().setRetention(this->maxMemories, spillPath);
+	}
+
+	//While enabled, getOptions returns its last result for a character (with the same numOfOptions and
+	//conversation type) until something that result read changes. Ties are then not reshuffled
+	void StoryTree::setCacheEnabled(bool enabled){
+		this->cacheEnabled = enabled;
+		this->optionCache.clear();
+		this->preconditionsStale = true;
+		if (this->trace != NULL){
+			TraceCall call;
+			call.type = TRACE_SET_CACHE_ENABLED;
+			call.enabled = enabled;
+			this->trace->write(call);
+		}
+	}
+
+	unsigned long long StoryTree::getCacheHits() const{
+		return this->optionCache.getHits();
+	}
+
+	unsigned long long StoryTree::getCacheMisses() const{
+		return this->optionCache.getMisses();
+	}
+
+	unsigned long long StoryTree::getCacheInvalidations() const{
+		return this->optionCache.getInvalidations();
+	}
+
+	//What the engine has spent on character since the stats were last reset
+	StoryStats StoryTree::getStats(std::string character){
+		Character* myChar = this->characterDB->getCharacter(character);
+		if (myChar == NULL){
+			std::cout << "getStats() error: There's no character with the name " << character << std::endl;
+			return StoryStats();
+		}
+		return myChar->getStats();
+	}
+
+	//Every character's stats, the most expensive first: by time spent finding its options, or by actions
+	//visited when the timers are compiled out
+	std::vector<std::pair<std::string, StoryStats>> StoryTree::getStatsSnapshot(){
+		std::vector<std::pair<std::string, StoryStats>> snapshot;
+		for (auto& name : this->characterDB->getListOfCharacters()){
+			snapshot.push_back(std::make_pair(name, this->characterDB->getCharacter(name)->getStats()));
+		}
+		std::stable_sort(snapshot.begin(), snapshot.end(), [](const std::pair<std::string, StoryStats>& a, const std::pair<std::string, StoryStats>& b){
+			if (a.second.traverseUs + a.second.rankUs != b.second.traverseUs + b.second.rankUs){
+				return a.second.traverseUs + a.second.rankUs > b.second.traverseUs + b.second.rankUs;
+			}
+			return a.second.nodesVisited > b.second.nodesVisited;
+		});
+		return snapshot;
+	}
+
+	void StoryTree::resetStats(){
+		for (auto& name : this->characterDB->getListOfCharacters()){
+			this->characterDB->getCharacter(name)->getStats() = StoryStats();
+		}
+	}
+
+	//Walks every structure this StoryTree holds and adds up the heap bytes each takes. Containers are
+	//counted by capacity, and hash map nodes are estimated, so it's close rather than exact; use
+	//AllocationTracker for what was really allocated
+	MemoryReport StoryTree::memoryReport(){
+		MemoryReport report;
+		report.sdb = this->mySDB->getMemoryUsage();
+		report.symbols = SymbolTable::global().getMemoryUsage();
+		report.dependencies = this->dependencies.getMemoryUsage();
+		report.optionCache = this->optionCache.getMemoryUsage();
+		report.scratch = this->arena.getMemoryUsage() + vectorBytes(this->workerArenas);
+		for (auto& workerArena : this->workerArenas){
+			report.scratch += workerArena.getMemoryUsage();
+		}
+		if (this->image != NULL){
+			report.mappedImage = (size_t)this->image->getSize();
+		}
+
+		report.characters = this->characterDB->getMemoryUsage();
+		for (auto& name : this->characterDB->getListOfCharacters()){
+			CharacterMemoryUsage usage = this->characterDB->getCharacter(name)->getMemoryUsage();
+			report.characters += usage.total();
+			report.perCharacter.push_back(usage);
+		}
+		std::stable_sort(report.perCharacter.begin(), report.perCharacter.end(), [](const CharacterMemoryUsage& a, const CharacterMemoryUsage& b){
+			return a.total() > b.total();
+		});
+		return report;
+	}
+
+	//Writes the SDB, every character's current values and every compiled ActionTree to path, for
+	//loadImage. Memories, retention and cache settings aren't part of the image
+	bool StoryTree::saveImage(std::string path){
+		this->refreshPreconditions();
+		return StoryImage::write(path, *(this->mySDB), *(this->characterDB));
+	}
+
+	//Loads a world saveImage wrote. It has to go into a StoryTree with nothing added yet. If the names
+	//the image was written with have the same symbol ids here, the trees run straight off the mapped
+	//file; otherwise each character gets its own copy with the ids translated
+	bool StoryTree::loadImage(std::string path){
+		TimelineScope scope(this->timeline, "loadImage");
+		if (this->image != NULL || !this->mySDB->isEmpty() || !this->characterDB->isEmpty()){
+			std::cout << "loadImage() error: A story image can only be loaded into an empty StoryTree" << std::endl;
+			return false;
+		}
+
+		//open checks the whole image, so nothing is interned for one that's rejected
+		StoryImage* loaded = new StoryImage();
+		if (!loaded->open(path)){
+			delete loaded;
+			return false;
+		}
+		this->image = loaded;
+
+		//symbolIDs[id in the image] is the name's id here
+		const StoryImageHeader& header = loaded->getHeader();
+		SymbolTable& symbols = SymbolTable::global();
+		std::vector<int> symbolIDs(header.stringCount);
+		bool sameIDs = true;
+		for (unsigned int id = 0; id < header.stringCount; id++){
+			symbolIDs[id] = symbols.intern(loaded->getString(id));
+			sameIDs = sameIDs && symbolIDs[id] == (int)id;
+		}
+
+		for (unsigned int slot = 0; slot < header.slotCount; slot++){
+			const ImageSlot& imageSlot = loaded->getSlot(slot);
+			SDBSlot info = { symbolIDs[imageSlot.clsID], symbolIDs[imageSlot.typeID], imageSlot.isBoolean != 0, imageSlot.defaultVal, imageSlot.min, imageSlot.max };
+			this->mySDB->addSlot(info);
+		}
+		this->characterDB->bindSDB(this->mySDB);
+
+		for (unsigned int character = 0; character < header.characterCount; character++){
+			std::string name = loaded->getString(loaded->getCharacter(character).nameID);
+			this->addCharacter(name);
+			Character* myChar = this->characterDB->getCharacter(name);
+			if (sameIDs){
+				myChar->mapActionTree(loaded->getTreeView(character));
+			}
+			else {
+				myChar->mapActionTree(loaded->getTreeView(character), symbolIDs);
+			}
+			myChar->setValues(loaded->getValues(character), header.slotCount);
+		}
+		this->preconditionsStale = true;
+		return true;
+	}
+
+	ThreadPool& StoryTree::getPool(){
+		if (this->pool == NULL){
+			this->setThreadCount(0);
+		}
+		return *(this->pool);
+	}
+
+	//Compiles every character's ActionTree, evaluates their preconditions from scratch, rebuilds the
+	//dependency index and empties the option cache, if anything but executeAction has changed the
+	//tree since the last time
+	void StoryTree::refreshPreconditions(){
+		if (!this->preconditionsStale){
+			return;
+		}
+		TimelineScope scope(this->timeline, "refreshPreconditions");
+
+		this->dependencies.clear();
+		this->optionCache.clear();
+
+		//Every character's values and actions bound what preconditions can read, so they all go in
+		//before any tree is pruned
+		std::vector<std::string> names = this->characterDB->getListOfCharacters();
+		ActionTreePruner pruner(*(this->mySDB));
+		for (auto& name : names){
+			int owner = SymbolTable::global().find(name);
+			pruner.addCharacter(owner, *(this->characterDB->getCharacter(owner)));
+		}
+
+		for (auto& name : names){
+			int owner = SymbolTable::global().find(name);
+			Character* myChar = this->characterDB->getCharacter(owner);
+			if (!myChar->getCompiledTree().isMapped()){
+				if (this->pruningEnabled){
+					pruner.prune(myChar->getActionTree());
+					myChar->compileActionTree(&pruner);
+				}
+				else {
+					myChar->compileActionTree();
+				}
+			}
+			const CompiledTree& tree = myChar->getCompiledTree();
+
+			//Every value a traversal of this character's tree can read, for the option cache
+			std::vector<SlotRef> reads;
+
+			myChar->resetSatisfied();
+			for (unsigned int node = 0; node < tree.size(); node++){
+				const CompiledAction& action = tree.getAction(node);
+				const PreconditionOp* preconditions = tree.getPreconditions(action);
+				myChar->setSatisfied(node, PreconditionProgram::evaluate(preconditions, action.preCount, *(this->characterDB), &(myChar->getStats())));
+				this->dependencies.addAction(owner, node, preconditions, action.preCount);
+
+				for (unsigned int i = 0; i < action.preCount; i++){
+					SlotRef read = { preconditions[i].character, preconditions[i].slot };
+					reads.push_back(read);
+				}
+				const ExpressionOp* expressions = tree.getExpressions(action);
+				for (unsigned int i = 0; i < action.expCount; i++){
+					if (expressions[i].slot >= 0){
+						SlotRef read = { expressions[i].character, expressions[i].slot };
+						reads.push_back(read);
+					}
+				}
+			}
+
+			std::sort(reads.begin(), reads.end(), [](const SlotRef& a, const SlotRef& b){
+				return (a.character != b.character) ? a.character < b.character : a.slot < b.slot;
+			});
+			reads.erase(std::unique(reads.begin(), reads.end(), [](const SlotRef& a, const SlotRef& b){
+				return a.character == b.character && a.slot == b.slot;
+			}), reads.end());
+			this->optionCache.setReads(owner, reads);
+		}
+		this->preconditionsStale = false;
+	}
+
+	//The character's slot has just changed, so evaluate again every action that reads it
+	void StoryTree::reevaluateDependents(int character, int slot){
+		if (this->preconditionsStale){
+			return;
+		}
+
+		const std::vector<ActionRef>* dependents = this->dependencies.getDependents(character, slot);
+		if (dependents == NULL){
+			return;
+		}
+		for (auto& ref : *dependents){
+			Character* myChar = this->characterDB->getCharacter(ref.owner);
+			const CompiledTree& tree = myChar->getCompiledTree();
+			const CompiledAction& action = tree.getAction(ref.action);
+			myChar->setSatisfied(ref.action, PreconditionProgram::evaluate(tree.getPreconditions(action), action.preCount, *(this->characterDB), &(myChar->getStats())));
+		}
+	}
+
+	//Checks whether owner's action node is satisfied and, if it is, adds its expressions' changes to memory
+	bool StoryTree::enterAction(const Character& owner, const CompiledTree& tree, int node, Memory& memory){
+		if (!owner.isSatisfied(node)){
+			return false;
+		}
+
+		const CompiledAction& action = tree.getAction(node);
+		const ExpressionOp* expressions = tree.getExpressions(action);
+		for (unsigned int i = 0; i < action.expCount; i++){
+			const ExpressionOp& exp = expressions[i];
+			const Character* target = this->characterDB->getCharacter(exp.character);
+			float change;
+			if (target != NULL && exp.slot >= 0 && Memory::getChange(exp, target->getValue(exp.slot), this->mySDB->getSlotInfo(exp.slot), change)){
+				memory.addVecValue(exp.key, change);
+			}
+		}
+		return true;
+	}
+
+	//Splits the top of the tree into subtrees until there are a few per worker, runs them across the
+	//pool, then copies each one's leaves into arena in the order a single traverse would have found them
+	void StoryTree::traverseParallel(const Character& owner, const CompiledTree& tree, TraversalArena& arena){
+		std::vector<TraversalTask>& tasks = arena.getTasks();
+		for (unsigned int first = 0; first < tree.getFirstCount(); first++){
+			TraversalTask task;
+			task.node = tree.getFirsts()[first];
+			task.depth = 0;
+			task.clsID = SymbolTable::NONE;
+			tasks.push_back(task);
+		}
+
+		//Replace every task that isn't a leaf with its children, one level at a time
+		unsigned int targetTasks = this->pool->getThreadCount() * 8;
+		std::vector<TraversalTask> expanded;
+		bool grew = true;
+		while (grew && tasks.size() < targetTasks){
+			grew = false;
+			expanded.clear();
+			for (auto& task : tasks){
+				const CompiledAction& action = tree.getAction(task.node);
+				if (action.flags & ACTION_LEAF){
+					expanded.push_back(task);
+					continue;
+				}
+				if (!this->enterAction(owner, tree, task.node, task.memory)){
+					continue;
+				}
+				ST_STATS_ADD(arena.getStats(), nodesVisited, 1);
+				ST_STATS_ADD(arena.getStats(), expressionsSimulated, action.expCount);
+
+				int myClass = task.clsID;
+				if (myClass == SymbolTable::NONE){
+					myClass = action.clsID;
+				}
+				const int* children = tree.getChildren(action);
+				for (unsigned int child = 0; child < action.childCount; child++){
+					TraversalTask childTask;
+					childTask.node = children[child];
+					childTask.depth = task.depth + 1;
+					childTask.clsID = myClass;
+					childTask.path = task.path;
+					childTask.path.push_back(tree.getUID(task.node));
+					childTask.memory = task.memory;
+					expanded.push_back(childTask);
+				}
+				grew = true;
+			}
+			tasks.swap(expanded);
+		}
+
+		for (auto& workerArena : this->workerArenas){
+			workerArena.reset();
+			workerArena.resetNodes(tree.size());
+		}
+		this->pool->parallelFor(tasks.size(), [&](unsigned int i, unsigned int worker){
+			TimelineScope scope(this->timeline, "traverseSubtree");
+			TraversalTask& task = tasks[i];
+			TraversalArena& workerArena = this->workerArenas[worker];
+			task.worker = worker;
+			task.leafBegin = workerArena.getLeafCount();
+
+			for (auto& uid : task.path){
+				workerArena.pushUID(uid);
+			}
+			workerArena.frame(task.depth) = task.memory;
+			this->traverse(owner, tree, task.node, task.depth, task.clsID, workerArena);
+			for (unsigned int popped = 0; popped < task.path.size(); popped++){
+				workerArena.popUID();
+			}
+
+			task.leafEnd = workerArena.getLeafCount();
+		});
+
+		for (auto& task : tasks){
+			arena.appendLeaves(this->workerArenas[task.worker], task.leafBegin, task.leafEnd);
+		}
+#if ST_STATS
+		for (auto& workerArena : this->workerArenas){
+			arena.getStats().add(workerArena.getStats());
+		}
+#endif
+	}
+
+	//Recursively walks the tree from action node. The incoming memory is already in arena.frame(depth);
+	//frames are reached through the arena every time since deeper calls may grow it.
+	//Actions reached by more than one path are only evaluated once, see NodeState
+	void StoryTree::traverse(const Character& owner, const CompiledTree& tree, int node, unsigned int depth, int clsID, TraversalArena& arena){
+		const CompiledAction& action = tree.getAction(node);
+		ST_STATS_ADD(arena.getStats(), nodesVisited, 1);
+
+		unsigned char state = arena.getNodeState(node);
+		if (state == NODE_FAILS || state == NODE_DEAD){
+			return;
+		}
+		if (state == NODE_UNSEEN){
+			if (!owner.isSatisfied(node)){
+				arena.setNodeState(node, NODE_FAILS);
+				return;
+			}
+
+			arena.beginNodeChanges(node);
+			ST_STATS_ADD(arena.getStats(), expressionsSimulated, action.expCount);
+			const ExpressionOp* expressions = tree.getExpressions(action);
+			for (unsigned int i = 0; i < action.expCount; i++){
+				const ExpressionOp& exp = expressions[i];
+				const Character* target = this->characterDB->getCharacter(exp.character);
+				float change;
+				if (target != NULL && exp.slot >= 0 && Memory::getChange(exp, target->getValue(exp.slot), this->mySDB->getSlotInfo(exp.slot), change)){
+					arena.addNodeChange(node, exp.key, change);
+				}
+			}
+			arena.setNodeState(node, NODE_PASSES);
+		}
+		arena.applyNodeChanges(node, arena.frame(depth));
+
+		arena.pushUID(tree.getUID(node));
+		unsigned int leavesBefore = arena.getLeafCount();
+
+		//The first class along a path is the one that path is known by
+		int myClass = clsID;
+		if (myClass == SymbolTable::NONE){
+			myClass = action.clsID;
+		}
+
+		if (action.flags & ACTION_LEAF){
+			ST_STATS_ADD(arena.getStats(), leavesScored, 1);
+			ST_STATS_ADD(arena.getStats(), memoryEntriesTouched, arena.frame(depth).getKeys().size());
+			const MemoryBank& memBank = owner.getMemoryBank();
+			float dotProduct = Memory::combinedDot(memBank.getTotalMemVec(), memBank.getSquaredLength(), arena.frame(depth), memBank.getTimeStep());
+			dotProduct = floor(dotProduct * 1000 + 0.5f) / 1000;
+
+			arena.addLeaf(fabs(this->conversationType - dotProduct), myClass);
+		}
+		else {
+			arena.reserveFrames(depth + 1);
+			const int* children = tree.getChildren(action);
+			for (unsigned int child = 0; child < action.childCount; child++){
+				arena.frame(depth + 1) = arena.frame(depth);
+				this->traverse(owner, tree, children[child], depth + 1, myClass, arena);
+			}
+		}
+
+		//Whether anything below an action passes doesn't depend on how it was reached
+		if (arena.getLeafCount() == leavesBefore){
+			arena.setNodeState(node, NODE_DEAD);
+		}
+
+		arena.popUID();
+	}
+}
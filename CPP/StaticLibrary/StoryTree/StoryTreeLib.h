@@ -5,9 +5,30 @@
 #include "SDBClass.h"
 #include "Characteristic.h"
 #include "Expression.h"
+#include "Precondition.h"
+#include "Action.h"
+#include "Memory.h"
+#include "TraversalArena.h"
+#include "OptionBatch.h"
+#include "DependencyIndex.h"
+#include "OptionCache.h"
+#include "CompiledTree.h"
+#include "ThreadPool.h"
+#include "StoryImage.h"
+#include "ActionTreePruner.h"
+#include "StoryTrace.h"
+#include "Timeline.h"
+#include "MemoryReport.h"
+#include "AllocationTracker.h"
+
+#include <random>
+#include <string>
+#include <vector>
 
 class SDB;
 class CharacterDB;
+class Character;
+class ActionTree;
 
 namespace ST{
 
@@ -16,10 +37,105 @@ namespace ST{
 		StoryTree();
 		~StoryTree();
 
+		void										addSDBClass(const SDBClass& cls);
+		void										addCharacter(std::string name);
+		void										addCharacteristic(const Characteristic& characteristic);
+		void										addAction(std::string character, const Action& action);
+
+		bool										loadSDB(std::string path);
+		bool										loadCharacters(std::string path);
+		bool										loadCharacteristics(std::string path);
+		bool										loadActions(std::string character, std::string path);
+		bool										loadActions(const std::vector<std::string>& characters, const std::vector<std::string>& paths);
+		bool										validateActions(std::string character);
+		void										setPruningEnabled(bool enabled);
+		PruneReport									getPruneReport(std::string character);
+
+		void										setConversationType(float conversationType);
+		void										setSeed(unsigned int seed);
+		void										setMemoryRetention(unsigned int maxMemories, std::string spillDirectory = "");
+
+		bool										saveImage(std::string path);
+		bool										loadImage(std::string path);
+
+		std::vector<std::vector<int>>				getOptions(std::string character, int numOfOptions);
+		OptionBatch									getOptionsBatch(const std::vector<std::string>& characters, int numOfOptions);
+		void										setThreadCount(unsigned int threadCount);
+		void										setSplitThreshold(unsigned int actions);
+		void										setCacheEnabled(bool enabled);
+		unsigned long long							getCacheHits() const;
+		unsigned long long							getCacheMisses() const;
+		unsigned long long							getCacheInvalidations() const;
+		StoryStats									getStats(std::string character);
+		std::vector<std::pair<std::string, StoryStats>>	getStatsSnapshot();
+		void										resetStats();
+		MemoryReport								memoryReport();
+		void										executeAction(std::string character, std::vector<int> uidPath);
+		std::string									getActionName(std::string character, int uid);
+
+		bool										startTrace(std::string tracePath, std::string imagePath = "");
+		void										stopTrace();
+		bool										restoreTraceState(const TraceState& state);
+
+		void										startTimeline();
+		bool										stopTimeline(std::string path);
+
 	private:
 		SDB*						mySDB;
 		CharacterDB*				characterDB;
+
+		//0.5 is balanced, higher favours paths like the character's history, lower favours novel ones
+		float						conversationType = 0.5f;
+		std::mt19937				rng;
+
+		//Applied to every character's MemoryBank, see MemoryBank::setRetention
+		unsigned int				maxMemories = 0;
+		std::string					spillDirectory;
+
+		TraversalArena				arena;
+
+		//The image loadImage mapped. Characters loaded from it traverse its arrays in place, unless its
+		//symbol ids had to be translated
+		StoryImage*					image = NULL;
+
+		//getOptionsBatch's and split traversals' workers, created on first use.
+		//Worker i traverses in workerArenas[i]
+		ThreadPool*					pool = NULL;
+		std::vector<TraversalArena>	workerArenas;
+		unsigned int				splitThreshold = 4096;
+
+		//Which actions read each value. Adding classes, characters, characteristics or actions marks
+		//every character's satisfied actions (and the option cache) stale; executeAction only
+		//re-evaluates the dependents of what it changed
+		DependencyIndex				dependencies;
+		bool						preconditionsStale = true;
+
+		//Whether compiling a character's ActionTree first prunes it, see ActionTreePruner
+		bool						pruningEnabled = true;
+
+		//getOptions results, reused until a value or memory bank they read changes
+		OptionCache					optionCache;
+		bool						cacheEnabled = true;
+
+		//Records every getOptions, getOptionsBatch and executeAction call while a trace is running
+		TraceWriter*				trace = NULL;
+
+		//Where the engine's phases are recorded between startTimeline and stopTimeline
+		Timeline*					timeline = NULL;
+
+		//private functions for use in getOptions and executeAction
+		std::vector<std::vector<int>>	lookupOptions(std::string character, int numOfOptions);
+		void						applyRetention(Character& character);
+		int							getTimelineCharacter(const std::string& character) const;
+		template<class Generator>
+		std::vector<std::vector<int>>	findOptions(const Character& myChar, int numOfOptions, TraversalArena& arena, Generator& rng, bool split);
+		ThreadPool&					getPool();
+		void						refreshPreconditions();
+		void						reevaluateDependents(int character, int slot);
+		bool						enterAction(const Character& owner, const CompiledTree& tree, int node, Memory& memory);
+		void						traverseParallel(const Character& owner, const CompiledTree& tree, TraversalArena& arena);
+		void						traverse(const Character& owner, const CompiledTree& tree, int node, unsigned int depth, int clsID, TraversalArena& arena);
 	};
 
 }
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,80 @@
+//SymbolTable.cpp
+#include "stdafx.h"
+#include "SymbolTable.h"
+#include "MemoryReport.h"
+
+#include <iostream>
+
+namespace ST{
+
+	SymbolTable::SymbolTable()
+	{
+	}
+
+
+	SymbolTable::~SymbolTable()
+	{
+	}
+
+	//The table every library object interns its names into
+	SymbolTable& SymbolTable::global(){
+		static SymbolTable table;
+		return table;
+	}
+
+	//VS2013 doesn't make initialising a function static thread safe, so the table is built while the
+	//program starts, before any thread can ask for it
+	static SymbolTable& startupTable = SymbolTable::global();
+
+	static const std::string noName;
+
+	//Returns the id for name, giving it the next free id if it hasn't been seen before
+	int SymbolTable::intern(const std::string& name){
+		std::lock_guard<std::mutex> lock(this->mutex);
+		auto idIt = this->ids.find(name);
+		if (idIt != this->ids.end()){
+			return idIt->second;
+		}
+
+		int id = this->names.size();
+		this->ids[name] = id;
+		this->names.push_back(name);
+		return id;
+	}
+
+	//Returns the id for name, or NONE if it was never interned
+	int SymbolTable::find(const std::string& name) const{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		auto idIt = this->ids.find(name);
+		if (idIt == this->ids.end()){
+			return NONE;
+		}
+		return idIt->second;
+	}
+
+	//Returns an empty name for an id that was never handed out
+	const std::string& SymbolTable::getName(int id) const{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		if (id < 0 || id >= (int)this->names.size()){
+			std::cout << "SymbolTable::getName() error: There's no symbol with the id " << id << std::endl;
+			return noName;
+		}
+		return this->names[id];
+	}
+
+	unsigned int SymbolTable::size() const{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		return this->names.size();
+	}
+
+	size_t SymbolTable::getMemoryUsage() const{
+		std::lock_guard<std::mutex> lock(this->mutex);
+		size_t bytes = hashMapBytes(this->ids) + this->names.size() * sizeof(std::string);
+		for (auto& name : this->names){
+			//Every name is held twice, once as a key of ids
+			bytes += 2 * stringBytes(name);
+		}
+		return bytes;
+	}
+
+}
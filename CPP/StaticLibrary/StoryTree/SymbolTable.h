@@ -0,0 +1,44 @@
+//SymbolTable.h
+#ifndef SymbolTable_H
+#define SymbolTable_H
+
+#include "stdafx.h"
+
+#include <deque>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+
+namespace ST{
+
+	//Maps every character, class and type name to a dense integer id when content is loaded,
+	//so the engine compares and hashes ints instead of strings.
+	//Names are only kept around for error messages and debugging, and this is the one place they're
+	//kept: library objects hold ids and look their names up here.
+	//Every StoryTree in the process shares the table, so each call takes its lock. A name is never
+	//moved once interned, so the references getName returns stay valid after the lock is released
+	class SymbolTable
+	{
+	public:
+		static const int								NONE = -1;
+
+		static SymbolTable&								global();
+
+		int												intern(const std::string& name);
+		int												find(const std::string& name) const;
+		const std::string&								getName(int id) const;
+		unsigned int									size() const;
+		size_t											getMemoryUsage() const;
+
+	private:
+		SymbolTable();
+		~SymbolTable();
+
+		std::unordered_map<std::string, int>			ids;
+		std::deque<std::string>							names;
+		mutable std::mutex								mutex;
+	};
+
+}
+
+#endif
@@ -0,0 +1,127 @@
+//ThreadPool.cpp
+#include "stdafx.h"
+#include "ThreadPool.h"
+
+namespace ST{
+
+	ThreadPool::ThreadPool(unsigned int threadCount)
+	{
+		if (threadCount == 0){
+			threadCount = 1;
+		}
+		for (unsigned int worker = 0; worker < threadCount; worker++){
+			this->ranges.push_back(std::unique_ptr<WorkRange>(new WorkRange()));
+		}
+		for (unsigned int worker = 1; worker < threadCount; worker++){
+			this->threads.push_back(std::thread(&ThreadPool::workerLoop, this, worker));
+		}
+	}
+
+
+	ThreadPool::~ThreadPool()
+	{
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->stopping = true;
+		}
+		this->wake.notify_all();
+		for (auto& thread : this->threads){
+			thread.join();
+		}
+	}
+
+	unsigned int ThreadPool::getThreadCount() const{
+		return this->ranges.size();
+	}
+
+	void ThreadPool::parallelFor(unsigned int count, const std::function<void(unsigned int, unsigned int)>& task){
+		{
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->task = &task;
+			unsigned int workers = this->ranges.size();
+			for (unsigned int worker = 0; worker < workers; worker++){
+				std::lock_guard<std::mutex> rangeLock(this->ranges[worker]->mutex);
+				this->ranges[worker]->next = (unsigned int)((unsigned long long)count * worker / workers);
+				this->ranges[worker]->end = (unsigned int)((unsigned long long)count * (worker + 1) / workers);
+			}
+			this->busyWorkers = this->threads.size();
+			this->generation++;
+		}
+		this->wake.notify_all();
+
+		this->runTasks(0);
+
+		std::unique_lock<std::mutex> lock(this->mutex);
+		this->done.wait(lock, [this](){ return this->busyWorkers == 0; });
+		this->task = NULL;
+	}
+
+	void ThreadPool::workerLoop(unsigned int worker){
+		unsigned int seenGeneration = 0;
+		while (true){
+			{
+				std::unique_lock<std::mutex> lock(this->mutex);
+				this->wake.wait(lock, [this, seenGeneration](){ return this->stopping || this->generation != seenGeneration; });
+				if (this->stopping){
+					return;
+				}
+				seenGeneration = this->generation;
+			}
+
+			this->runTasks(worker);
+
+			std::lock_guard<std::mutex> lock(this->mutex);
+			this->busyWorkers--;
+			if (this->busyWorkers == 0){
+				this->done.notify_all();
+			}
+		}
+	}
+
+	//Runs the worker's own range, then keeps stealing until every range is empty
+	void ThreadPool::runTasks(unsigned int worker){
+		unsigned int index;
+		do {
+			while (this->claim(worker, index)){
+				(*(this->task))(index, worker);
+			}
+		} while (this->steal(worker));
+	}
+
+	bool ThreadPool::claim(unsigned int worker, unsigned int& index){
+		WorkRange& range = *(this->ranges[worker]);
+		std::lock_guard<std::mutex> lock(range.mutex);
+		if (range.next >= range.end){
+			return false;
+		}
+		index = range.next++;
+		return true;
+	}
+
+	//Moves the back half of the first non-empty range found into this worker's range
+	bool ThreadPool::steal(unsigned int worker){
+		unsigned int workers = this->ranges.size();
+		for (unsigned int offset = 1; offset < workers; offset++){
+			unsigned int stolenNext;
+			unsigned int stolenEnd;
+			{
+				WorkRange& victim = *(this->ranges[(worker + offset) % workers]);
+				std::lock_guard<std::mutex> lock(victim.mutex);
+				if (victim.next >= victim.end){
+					continue;
+				}
+				stolenEnd = victim.end;
+				stolenNext = victim.end - (victim.end - victim.next + 1) / 2;
+				victim.end = stolenNext;
+			}
+
+			WorkRange& range = *(this->ranges[worker]);
+			std::lock_guard<std::mutex> lock(range.mutex);
+			range.next = stolenNext;
+			range.end = stolenEnd;
+			return true;
+		}
+		return false;
+	}
+
+}
@@ -0,0 +1,63 @@
+//ThreadPool.h
+#ifndef ThreadPool_H
+#define ThreadPool_H
+
+#include "stdafx.h"
+
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace ST{
+
+	//A fixed set of worker threads that run parallel loops. The thread calling parallelFor
+	//works too, as worker 0, so a pool of one thread runs everything inline.
+	//Each loop's indices are dealt out to the workers as contiguous ranges; a worker that runs out
+	//steals the back half of another's remaining range, so a few expensive indices don't leave
+	//the rest of the pool idle
+	class ThreadPool
+	{
+	public:
+		ThreadPool(unsigned int threadCount);
+		~ThreadPool();
+
+		unsigned int								getThreadCount() const;
+
+		//Calls task(index, worker) for every index in [0, count) and returns once they've all finished.
+		//worker is in [0, getThreadCount()), so tasks can index per-worker scratch space
+		void										parallelFor(unsigned int count, const std::function<void(unsigned int, unsigned int)>& task);
+
+	private:
+		std::vector<std::thread>					threads;
+
+		std::mutex									mutex;
+		std::condition_variable						wake;
+		std::condition_variable						done;
+
+		//The indices [next, end) a worker has left to run. Only ever lock one range at a time
+		struct WorkRange{
+			std::mutex								mutex;
+			unsigned int							next = 0;
+			unsigned int							end = 0;
+		};
+
+		//The loop being run. generation changes every parallelFor so sleeping workers know there's work
+		const std::function<void(unsigned int, unsigned int)>*	task = NULL;
+		std::vector<std::unique_ptr<WorkRange>>		ranges;
+		unsigned int								busyWorkers = 0;
+		unsigned int								generation = 0;
+		bool										stopping = false;
+
+		//private functions for the workers
+		void										workerLoop(unsigned int worker);
+		void										runTasks(unsigned int worker);
+		bool										claim(unsigned int worker, unsigned int& index);
+		bool										steal(unsigned int worker);
+	};
+
+}
+
+#endif
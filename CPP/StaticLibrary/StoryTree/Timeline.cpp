@@ -0,0 +1,139 @@
+//Timeline.cpp
+#include "stdafx.h"
+#include "Timeline.h"
+#include "StoryStats.h"
+#include "SymbolTable.h"
+
+#include <fstream>
+#include <iostream>
+
+namespace ST{
+
+	//Names can hold anything, so they're escaped before going into JSON
+	static void writeJsonString(std::ostream& out, const std::string& text){
+		out << '"';
+		for (auto& c : text){
+			if (c == '"' || c == '\\'){
+				out << '\\' << c;
+			}
+			else if ((unsigned char)c < 0x20){
+				static const char* hex = "0123456789abcdef";
+				out << "\\u00" << hex[(c >> 4) & 0xF] << hex[c & 0xF];
+			}
+			else {
+				out << c;
+			}
+		}
+		out << '"';
+	}
+
+	Timeline::Timeline()
+	{
+		for (auto& buffer : this->buffers){
+			buffer.used.store(false);
+		}
+		this->bufferCount.store(0);
+		this->dropped.store(0);
+		this->origin = StoryStats::now();
+	}
+
+
+	Timeline::~Timeline()
+	{
+	}
+
+	void Timeline::record(const char* name, int character, double start, double end){
+		ThreadBuffer* buffer = this->getBuffer();
+		if (buffer == NULL || buffer->events.size() >= MAX_EVENTS){
+			this->dropped++;
+			return;
+		}
+		TimelineEvent event = { name, character, start - this->origin, end - this->origin };
+		buffer->events.push_back(event);
+	}
+
+	//The events go out as complete ("X") events, one thread per buffer, with times in microseconds
+	bool Timeline::write(std::string path) const{
+		std::ofstream out(path.c_str());
+		if (!out){
+			std::cout << "Timeline::write() error: Couldn't open " << path << std::endl;
+			return false;
+		}
+
+		SymbolTable& symbols = SymbolTable::global();
+		out << "{\"traceEvents\": [";
+		out.precision(3);
+		out << std::fixed;
+		bool firstEvent = true;
+		unsigned int count = this->bufferCount.load();
+		for (unsigned int thread = 0; thread < count; thread++){
+			const ThreadBuffer& buffer = this->buffers[thread];
+			if (!buffer.used.load()){
+				continue;
+			}
+			out << (firstEvent ? "\n" : ",\n");
+			firstEvent = false;
+			out << "{\"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": " << thread + 1
+				<< ", \"args\": {\"name\": \"StoryTree thread " << thread + 1 << "\"}}";
+
+			for (auto& event : buffer.events){
+				out << ",\n{\"name\": \"" << event.name << "\", \"cat\": \"StoryTree\", \"ph\": \"X\", \"pid\": 1, \"tid\": " << thread + 1
+					<< ", \"ts\": " << event.start << ", \"dur\": " << event.end - event.start;
+				if (event.character != SymbolTable::NONE){
+					out << ", \"args\": {\"character\": ";
+					writeJsonString(out, symbols.getName(event.character));
+					out << "}";
+				}
+				out << "}";
+			}
+		}
+		out << "\n], \"displayTimeUnit\": \"ms\", \"otherData\": {\"droppedEvents\": " << this->dropped.load() << "}}" << std::endl;
+		return (bool)out;
+	}
+
+	//Empties every buffer, keeping each thread's, so the next events start from a fresh timeline
+	void Timeline::clear(){
+		unsigned int count = this->bufferCount.load();
+		for (unsigned int thread = 0; thread < count; thread++){
+			this->buffers[thread].events.clear();
+		}
+		this->dropped.store(0);
+		this->origin = StoryStats::now();
+	}
+
+	//The calling thread's buffer, claiming the next free one the first time it records
+	Timeline::ThreadBuffer* Timeline::getBuffer(){
+		std::thread::id me = std::this_thread::get_id();
+		unsigned int count = this->bufferCount.load(std::memory_order_acquire);
+		for (unsigned int thread = 0; thread < count; thread++){
+			if (this->buffers[thread].used.load(std::memory_order_acquire) && this->buffers[thread].owner == me){
+				return &(this->buffers[thread]);
+			}
+		}
+
+		std::lock_guard<std::mutex> lock(this->claimMutex);
+		count = this->bufferCount.load();
+		if (count >= MAX_THREADS){
+			return NULL;
+		}
+		ThreadBuffer& buffer = this->buffers[count];
+		buffer.owner = me;
+		buffer.used.store(true, std::memory_order_release);
+		this->bufferCount.store(count + 1, std::memory_order_release);
+		return &buffer;
+	}
+
+	TimelineScope::TimelineScope(Timeline* timeline, const char* name, int character) : timeline(timeline), name(name), character(character)
+	{
+		this->start = (timeline != NULL) ? StoryStats::now() : 0;
+	}
+
+
+	TimelineScope::~TimelineScope()
+	{
+		if (this->timeline != NULL){
+			this->timeline->record(this->name, this->character, this->start, StoryStats::now());
+		}
+	}
+
+}
@@ -0,0 +1,80 @@
+//Timeline.h
+#ifndef Timeline_H
+#define Timeline_H
+
+#include "stdafx.h"
+
+#include <atomic>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace ST{
+
+	//One span of engine work. name is a string literal; character is a symbol id, or SymbolTable::NONE
+	struct TimelineEvent{
+		const char*									name;
+		int											character;
+		double										start;
+		double										end;
+	};
+
+	//Collects what the engine's threads spend their time on, for viewing as a timeline. Every thread
+	//records into a buffer only it writes to, found without locking; the lock is only taken the first
+	//time a thread records. write saves the events as a Chrome JSON trace, which chrome://tracing and
+	//ui.perfetto.dev both open. Only call write and clear while nothing is recording
+	class Timeline
+	{
+	public:
+		Timeline();
+		~Timeline();
+
+		void										record(const char* name, int character, double start, double end);
+		bool										write(std::string path) const;
+		void										clear();
+
+	private:
+		//Threads past the last buffer, and events past a buffer's limit, are dropped and counted
+		static const unsigned int					MAX_THREADS = 64;
+		static const unsigned int					MAX_EVENTS = 1 << 20;
+
+		struct ThreadBuffer{
+			std::atomic<bool>						used;
+			std::thread::id							owner;
+			std::vector<TimelineEvent>				events;
+		};
+
+		ThreadBuffer								buffers[MAX_THREADS];
+		std::atomic<unsigned int>					bufferCount;
+		std::mutex									claimMutex;
+		std::atomic<unsigned long long>				dropped;
+		double										origin;
+
+		//private functions for record
+		ThreadBuffer*								getBuffer();
+
+		Timeline(const Timeline&);
+		Timeline&									operator=(const Timeline&);
+	};
+
+	//Records the span it lives for, if there's a timeline to record it to
+	class TimelineScope
+	{
+	public:
+		TimelineScope(Timeline* timeline, const char* name, int character = -1);
+		~TimelineScope();
+
+	private:
+		Timeline*									timeline;
+		const char*									name;
+		int											character;
+		double										start;
+
+		TimelineScope(const TimelineScope&);
+		TimelineScope&								operator=(const TimelineScope&);
+	};
+
+}
+
+#endif
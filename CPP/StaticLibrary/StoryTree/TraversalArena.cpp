@@ -0,0 +1,171 @@
+//TraversalArena.cpp
+#include "stdafx.h"
+#include "TraversalArena.h"
+#include "MemoryReport.h"
+
+namespace ST{
+
+	TraversalArena::TraversalArena()
+	{
+	}
+
+
+	TraversalArena::~TraversalArena()
+	{
+	}
+
+	//Forget the last query, keeping every buffer's capacity
+	void TraversalArena::reset(){
+		this->path.clear();
+		this->leafPaths.clear();
+		this->leafOffsets.clear();
+		this->leafOffsets.push_back(0);
+		this->leafDists.clear();
+		this->leafClasses.clear();
+		this->order.clear();
+		this->tieBreaks.clear();
+		this->offeredClasses.clear();
+		this->tasks.clear();
+		this->stats = StoryStats();
+	}
+
+	Memory& TraversalArena::frame(unsigned int depth){
+		this->reserveFrames(depth);
+		return this->frames[depth];
+	}
+
+	//Frames are handed out by reference, so grow them before a caller holds one
+	void TraversalArena::reserveFrames(unsigned int depth){
+		if (depth >= this->frames.size()){
+			ST_STATS_GROWTH(this->stats, this->frames, depth + 1 - this->frames.size());
+			this->frames.resize(depth + 1);
+		}
+	}
+
+	void TraversalArena::pushUID(int uid){
+		ST_STATS_GROWTH(this->stats, this->path, 1);
+		this->path.push_back(uid);
+	}
+
+	void TraversalArena::popUID(){
+		this->path.pop_back();
+	}
+
+	void TraversalArena::addLeaf(float dist, int clsID){
+		ST_STATS_GROWTH(this->stats, this->leafPaths, this->path.size());
+		ST_STATS_GROWTH(this->stats, this->leafOffsets, 1);
+		ST_STATS_GROWTH(this->stats, this->leafDists, 1);
+		ST_STATS_GROWTH(this->stats, this->leafClasses, 1);
+		this->leafPaths.insert(this->leafPaths.end(), this->path.begin(), this->path.end());
+		this->leafOffsets.push_back(this->leafPaths.size());
+		this->leafDists.push_back(dist);
+		this->leafClasses.push_back(clsID);
+	}
+
+	//Copies leaves [begin, end) of another arena onto the end of this one's
+	void TraversalArena::appendLeaves(const TraversalArena& from, unsigned int begin, unsigned int end){
+		for (unsigned int leaf = begin; leaf < end; leaf++){
+			this->leafPaths.insert(this->leafPaths.end(), from.leafPaths.begin() + from.leafOffsets[leaf], from.leafPaths.begin() + from.leafOffsets[leaf + 1]);
+			this->leafOffsets.push_back(this->leafPaths.size());
+			this->leafDists.push_back(from.leafDists[leaf]);
+			this->leafClasses.push_back(from.leafClasses[leaf]);
+		}
+	}
+
+	const std::vector<int>& TraversalArena::getPath() const{
+		return this->path;
+	}
+
+	//Forgets every action's state, ready for a query on a tree of nodeCount actions
+	void TraversalArena::resetNodes(unsigned int nodeCount){
+		this->nodeStates.assign(nodeCount, NODE_UNSEEN);
+		this->changeBegin.resize(nodeCount);
+		this->changeEnd.resize(nodeCount);
+		this->changeKeys.clear();
+		this->changeValues.clear();
+	}
+
+	unsigned char TraversalArena::getNodeState(int node) const{
+		return this->nodeStates[node];
+	}
+
+	void TraversalArena::setNodeState(int node, unsigned char state){
+		this->nodeStates[node] = state;
+	}
+
+	//A node's changes are added straight after beginNodeChanges, before any other node's
+	void TraversalArena::beginNodeChanges(int node){
+		this->changeBegin[node] = this->changeKeys.size();
+		this->changeEnd[node] = this->changeKeys.size();
+	}
+
+	void TraversalArena::addNodeChange(int node, int key, float change){
+		ST_STATS_GROWTH(this->stats, this->changeKeys, 1);
+		ST_STATS_GROWTH(this->stats, this->changeValues, 1);
+		this->changeKeys.push_back(key);
+		this->changeValues.push_back(change);
+		this->changeEnd[node] = this->changeKeys.size();
+	}
+
+	void TraversalArena::applyNodeChanges(int node, Memory& memory){
+		ST_STATS_ADD(this->stats, memoryEntriesTouched, this->changeEnd[node] - this->changeBegin[node]);
+		for (unsigned int i = this->changeBegin[node]; i < this->changeEnd[node]; i++){
+			memory.addVecValue(this->changeKeys[i], this->changeValues[i]);
+		}
+	}
+
+	unsigned int TraversalArena::getLeafCount() const{
+		return this->leafDists.size();
+	}
+
+	float TraversalArena::getLeafDist(unsigned int leaf) const{
+		return this->leafDists[leaf];
+	}
+
+	int TraversalArena::getLeafClass(unsigned int leaf) const{
+		return this->leafClasses[leaf];
+	}
+
+	std::vector<int> TraversalArena::getLeafPath(unsigned int leaf) const{
+		return std::vector<int>(this->leafPaths.begin() + this->leafOffsets[leaf], this->leafPaths.begin() + this->leafOffsets[leaf + 1]);
+	}
+
+	std::vector<unsigned int>& TraversalArena::getOrder(){
+		return this->order;
+	}
+
+	std::vector<unsigned int>& TraversalArena::getTieBreaks(){
+		return this->tieBreaks;
+	}
+
+	std::vector<bool>& TraversalArena::getUsedClasses(){
+		return this->usedClasses;
+	}
+
+	std::vector<int>& TraversalArena::getOfferedClasses(){
+		return this->offeredClasses;
+	}
+
+	std::vector<TraversalTask>& TraversalArena::getTasks(){
+		return this->tasks;
+	}
+
+	StoryStats& TraversalArena::getStats(){
+		return this->stats;
+	}
+
+	size_t TraversalArena::getMemoryUsage() const{
+		size_t bytes = vectorBytes(this->frames) + vectorBytes(this->path) + vectorBytes(this->leafPaths) + vectorBytes(this->leafOffsets) +
+			vectorBytes(this->leafDists) + vectorBytes(this->leafClasses) + vectorBytes(this->order) + vectorBytes(this->tieBreaks) +
+			vectorBytes(this->usedClasses) + vectorBytes(this->offeredClasses) + vectorBytes(this->nodeStates) + vectorBytes(this->changeBegin) + vectorBytes(this->changeEnd) +
+			vectorBytes(this->changeKeys) + vectorBytes(this->changeValues) + vectorBytes(this->tasks);
+		for (auto& frame : this->frames){
+			bytes += frame.getMemoryUsage();
+		}
+		for (auto& task : this->tasks){
+			bytes += vectorBytes(task.path) + task.memory.getMemoryUsage();
+		}
+		return bytes;
+	}
+
+}
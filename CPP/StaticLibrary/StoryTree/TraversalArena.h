@@ -0,0 +1,118 @@
+//TraversalArena.h
+#ifndef TraversalArena_H
+#define TraversalArena_H
+
+#include "stdafx.h"
+
+#include "Memory.h"
+#include "StoryStats.h"
+
+#include <string>
+#include <vector>
+
+namespace ST{
+
+	//A subtree of one getOptions traversal that can run on its own: traverse action node at depth,
+	//with the uid path above it and the memory the actions along that path built up.
+	//Once run, its leaves are [leafBegin, leafEnd) of the arena worker traversed it in
+	struct TraversalTask{
+		int											node;
+		unsigned int								depth;
+		int											clsID;
+		std::vector<int>							path;
+		Memory										memory;
+
+		unsigned int								worker;
+		unsigned int								leafBegin;
+		unsigned int								leafEnd;
+	};
+
+	//What one traversal has learnt about an action (by ActionTree index). Preconditions and the
+	//changes an action's expressions make only depend on character state, which can't change
+	//during a query, so each is worked out the first time the action is reached. A DEAD action
+	//passed but no leaf below it did, so every other path into it can skip it too
+	enum NodeState{
+		NODE_UNSEEN = 0,
+		NODE_FAILS = 1,
+		NODE_PASSES = 2,
+		NODE_DEAD = 3
+	};
+
+	//Scratch buffers reused by every StoryTree::getOptions call.
+	//The uid path is a stack that grows and shrinks with the traversal, and every depth
+	//owns one Memory frame, so visiting a child never copies a path or allocates a Memory.
+	//Leaves are written into flat buffers; nothing is released between calls, so after
+	//the first few queries a traversal allocates nothing.
+	class TraversalArena
+	{
+	public:
+		TraversalArena();
+		~TraversalArena();
+
+		void										reset();
+
+		Memory&										frame(unsigned int depth);
+		void										reserveFrames(unsigned int depth);
+
+		void										pushUID(int uid);
+		void										popUID();
+
+		void										addLeaf(float dist, int clsID);
+		void										appendLeaves(const TraversalArena& from, unsigned int begin, unsigned int end);
+		const std::vector<int>&						getPath() const;
+
+		void										resetNodes(unsigned int nodeCount);
+		unsigned char								getNodeState(int node) const;
+		void										setNodeState(int node, unsigned char state);
+		void										beginNodeChanges(int node);
+		void										addNodeChange(int node, int key, float change);
+		void										applyNodeChanges(int node, Memory& memory);
+
+		unsigned int								getLeafCount() const;
+		float										getLeafDist(unsigned int leaf) const;
+		int											getLeafClass(unsigned int leaf) const;
+		std::vector<int>							getLeafPath(unsigned int leaf) const;
+
+		std::vector<unsigned int>&					getOrder();
+		std::vector<unsigned int>&					getTieBreaks();
+		std::vector<bool>&							getUsedClasses();
+		std::vector<int>&							getOfferedClasses();
+		std::vector<TraversalTask>&					getTasks();
+		StoryStats&									getStats();
+		size_t										getMemoryUsage() const;
+
+	private:
+		std::vector<Memory>							frames;
+		std::vector<int>							path;
+
+		//Leaf i's uid path is leafPaths[leafOffsets[i] .. leafOffsets[i + 1])
+		std::vector<int>							leafPaths;
+		std::vector<unsigned int>					leafOffsets;
+		std::vector<float>							leafDists;
+		std::vector<int>							leafClasses;
+
+		//Scratch space for ranking the leaves: the leaf heap, one random tie break per leaf,
+		//a bit per class of the tree that has already been offered, and those classes
+		std::vector<unsigned int>					order;
+		std::vector<unsigned int>					tieBreaks;
+		std::vector<bool>							usedClasses;
+		std::vector<int>							offeredClasses;
+
+		//One NodeState per action, and the (key, change) pairs each passing action adds to a memory:
+		//node i's are changeKeys/changeValues[changeBegin[i] .. changeEnd[i])
+		std::vector<unsigned char>					nodeStates;
+		std::vector<unsigned int>					changeBegin;
+		std::vector<unsigned int>					changeEnd;
+		std::vector<int>							changeKeys;
+		std::vector<float>							changeValues;
+
+		//The subtrees a large traversal was split into, in the order their leaves are merged
+		std::vector<TraversalTask>					tasks;
+
+		//What the current query has done so far
+		StoryStats									stats;
+	};
+
+}
+
+#endif
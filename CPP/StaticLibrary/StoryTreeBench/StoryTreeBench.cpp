@@ -0,0 +1,497 @@
+// StoryTreeBench.cpp : Times loading, getOptions and executeAction on generated worlds.
+//
+// StoryTreeBench [--preset=small|medium|large] [--characters=N] [--classes=N] [--types=N] [--depth=N]
+//                [--branching=N] [--sharing=F] [--preconditions=F] [--expressions=F] [--seed=N]
+//                [--calls=N] [--executes=N] [--record=path] [--timeline=path] [--allocations=1] [--out=path]
+// StoryTreeBench --replay=trace [--image=path] [--out=path]
+//
+// With no world options every preset runs. Results are written as JSON to --out, or to stdout,
+// and progress goes to stderr.
+// --record traces each run's timed calls to path (with the preset's name added when several run),
+// saving the image to go with it next to it as path.stim. --timeline writes each run's engine phases,
+// from generating the world to the last executeAction, to path (named the same way) as a Chrome JSON
+// trace. --allocations counts every allocation the process makes, which slows the timed calls down a
+// little, and adds how many each call made and how many bytes stayed allocated across them. --replay runs a trace against its image,
+// path.stim unless --image says otherwise, and reports each kind of call's latency and every call
+// whose options came out differently
+
+#include "stdafx.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "StoryTreeLib.h"
+#include "WorldGenerator.h"
+
+#ifdef _WIN32
+#define NOMINMAX
+#include <windows.h>
+#include <psapi.h>
+#pragma comment(lib, "psapi.lib")
+#else
+#include <chrono>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
+//Every allocation goes through ST::AllocationTracker, which only counts while --allocations turns it on
+ST_COUNT_GLOBAL_ALLOCATIONS()
+
+struct BenchConfig{
+	string								name;
+	WorldSpec							spec;
+	unsigned int						calls = 2000;
+	unsigned int						executes = 20000;
+	string								recordPath;
+	string								timelinePath;
+	bool								allocations = false;
+};
+
+struct BenchResult{
+	unsigned int						actions = 0;
+	double								loadMs = 0;
+	double								imageLoadMs = 0;
+	unsigned int						calls = 0;
+	double								meanUs = 0;
+	double								p50Us = 0;
+	double								p90Us = 0;
+	double								p99Us = 0;
+	double								maxUs = 0;
+	unsigned int						executes = 0;
+	double								executesPerSecond = 0;
+	long long							bytesPerCharacter = 0;
+	ST::MemoryReport					memory;
+
+	//Only with --allocations. retainedBytes is what the timed getOptions calls left allocated,
+	//which is 0 unless something leaks or a cache or scratch buffer grows
+	long long							trackedBytes = 0;
+	double								allocationsPerGetOptions = 0;
+	long long							retainedBytes = 0;
+	double								allocationsPerExecute = 0;
+};
+
+//The latencies of one kind of call in a replay
+struct ReplayTimes{
+	vector<double>						times;
+	unsigned int						divergent = 0;
+};
+
+//VS2013's std::chrono clocks only tick about once a millisecond, so Windows uses the performance counter
+static double nowUs(){
+#ifdef _WIN32
+	static LARGE_INTEGER frequency = { 0 };
+	if (frequency.QuadPart == 0){
+		QueryPerformanceFrequency(&frequency);
+	}
+	LARGE_INTEGER counter;
+	QueryPerformanceCounter(&counter);
+	return counter.QuadPart * 1000000.0 / frequency.QuadPart;
+#else
+	return chrono::duration<double, micro>(chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+//The process's resident memory, for telling how much a world takes up
+static long long residentBytes(){
+#ifdef _WIN32
+	PROCESS_MEMORY_COUNTERS counters;
+	if (!GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))){
+		return 0;
+	}
+	return counters.WorkingSetSize;
+#else
+	long long pages = 0;
+	long long resident = 0;
+	ifstream statm("/proc/self/statm");
+	if (!(statm >> pages >> resident)){
+		return 0;
+	}
+	return resident * sysconf(_SC_PAGESIZE);
+#endif
+}
+
+//Nearest rank, so every percentile is a time that was actually measured
+static double percentile(const vector<double>& sorted, double fraction){
+	if (sorted.empty()){
+		return 0;
+	}
+	size_t rank = (size_t)ceil(fraction * sorted.size());
+	return sorted[(rank == 0) ? 0 : rank - 1];
+}
+
+static BenchConfig preset(string name){
+	BenchConfig config;
+	config.name = name;
+	if (name == "medium"){
+		config.spec.characters = 50;
+		config.spec.classes = 16;
+		config.spec.depth = 5;
+	}
+	else if (name == "large"){
+		config.spec.characters = 200;
+		config.spec.classes = 32;
+		config.spec.typesPerClass = 8;
+		config.spec.depth = 5;
+		config.spec.branching = 4;
+		config.calls = 1000;
+	}
+	return config;
+}
+
+static BenchResult run(const BenchConfig& config){
+	BenchResult result;
+	const WorldSpec& spec = config.spec;
+	WorldGenerator generator(spec);
+	string imagePath = "StoryTreeBench_" + config.name + ".stim";
+
+	//The first getOptions compiles every character's tree, so it counts as loading
+	long long memoryBefore = residentBytes();
+	ST::AllocationTracker::setEnabled(config.allocations);
+	long long trackedBefore = ST::AllocationTracker::getStats().liveBytes;
+	double start = nowUs();
+	ST::StoryTree* storyTree = new ST::StoryTree();
+	if (!config.timelinePath.empty()){
+		storyTree->startTimeline();
+	}
+	storyTree->setSeed(spec.seed);
+	storyTree->setCacheEnabled(false);
+	generator.generate(*storyTree);
+	storyTree->getOptions(generator.getCharacterName(0), 3);
+	result.loadMs = (nowUs() - start) / 1000;
+	result.actions = generator.getActionCount();
+	result.bytesPerCharacter = (residentBytes() - memoryBefore) / (long long)spec.characters;
+	result.trackedBytes = ST::AllocationTracker::getStats().liveBytes - trackedBefore;
+
+	//Without the cache every call traverses, so this is the cost of a getOptions after a change
+	for (unsigned int character = 0; character < spec.characters; character++){
+		storyTree->getOptions(generator.getCharacterName(character), 3);
+	}
+	if (!config.recordPath.empty()){
+		storyTree->startTrace(config.recordPath, config.recordPath + ".stim");
+	}
+	vector<double> times;
+	vector<string> names;
+	for (unsigned int character = 0; character < spec.characters; character++){
+		names.push_back(generator.getCharacterName(character));
+	}
+	ST::AllocationTracker::resetStats();
+	ST::AllocationStats allocationsBefore = ST::AllocationTracker::getStats();
+	for (unsigned int call = 0; call < config.calls; call++){
+		const string& character = names[call % spec.characters];
+		start = nowUs();
+		storyTree->getOptions(character, 3);
+		times.push_back(nowUs() - start);
+	}
+	ST::AllocationStats allocationsAfter = ST::AllocationTracker::getStats();
+	result.allocationsPerGetOptions = (config.calls > 0) ? (double)(allocationsAfter.allocations - allocationsBefore.allocations) / config.calls : 0;
+	result.retainedBytes = allocationsAfter.liveBytes - allocationsBefore.liveBytes;
+	sort(times.begin(), times.end());
+	result.calls = times.size();
+	for (auto& time : times){
+		result.meanUs += time;
+	}
+	result.meanUs /= max<size_t>(times.size(), 1);
+	result.p50Us = percentile(times, 0.5);
+	result.p90Us = percentile(times, 0.9);
+	result.p99Us = percentile(times, 0.99);
+	result.maxUs = times.empty() ? 0 : times.back();
+
+	//Each character executes one of its options over and over, and characters take turns
+	vector<vector<int>> paths;
+	for (unsigned int character = 0; character < spec.characters; character++){
+		vector<vector<int>> options = storyTree->getOptions(generator.getCharacterName(character), 1);
+		paths.push_back(options.empty() ? vector<int>() : options[0]);
+	}
+	allocationsBefore = ST::AllocationTracker::getStats();
+	start = nowUs();
+	for (unsigned int execute = 0; execute < config.executes; execute++){
+		unsigned int character = execute % spec.characters;
+		if (!paths[character].empty()){
+			storyTree->executeAction(generator.getCharacterName(character), paths[character]);
+			result.executes++;
+		}
+	}
+	double executeUs = nowUs() - start;
+	allocationsAfter = ST::AllocationTracker::getStats();
+	result.allocationsPerExecute = (result.executes > 0) ? (double)(allocationsAfter.allocations - allocationsBefore.allocations) / result.executes : 0;
+	result.executesPerSecond = (executeUs > 0) ? result.executes * 1000000.0 / executeUs : 0;
+	//Taken after the executes, so the memory banks have something in them
+	result.memory = storyTree->memoryReport();
+	storyTree->stopTrace();
+	if (!config.timelinePath.empty()){
+		storyTree->stopTimeline(config.timelinePath);
+	}
+
+	storyTree->saveImage(imagePath);
+	delete storyTree;
+
+	start = nowUs();
+	ST::StoryTree* loaded = new ST::StoryTree();
+	if (loaded->loadImage(imagePath)){
+		loaded->getOptions(generator.getCharacterName(0), 3);
+		result.imageLoadMs = (nowUs() - start) / 1000;
+	}
+	delete loaded;
+	remove(imagePath.c_str());
+	ST::AllocationTracker::setEnabled(false);
+
+	return result;
+}
+
+//Makes the calls a trace recorded against the image saved with it, timing each one. A call diverges
+//when it returns different options than it did when it was recorded
+static int replay(string tracePath, string imagePath, ostream& out){
+	ST::TraceReader reader;
+	if (!reader.open(tracePath)){
+		cerr << "StoryTreeBench error: " << reader.getError() << endl;
+		return 1;
+	}
+
+	double start = nowUs();
+	ST::StoryTree* storyTree = new ST::StoryTree();
+	if (!storyTree->loadImage(imagePath) || !storyTree->restoreTraceState(reader.getState())){
+		cerr << "StoryTreeBench error: Couldn't load " << imagePath << " for " << tracePath << endl;
+		delete storyTree;
+		return 1;
+	}
+	double imageLoadMs = (nowUs() - start) / 1000;
+
+	ReplayTimes getOptions;
+	ReplayTimes getOptionsBatch;
+	ReplayTimes executeAction;
+	unsigned int calls = 0;
+	long long firstDivergent = -1;
+	ST::TraceCall call;
+	while (reader.next(call)){
+		bool same = true;
+		ReplayTimes* kind = NULL;
+		start = nowUs();
+		switch (call.type){
+		case ST::TRACE_GET_OPTIONS:
+			same = (storyTree->getOptions(call.characters[0], call.numOfOptions) == call.options[0]);
+			kind = &getOptions;
+			break;
+		case ST::TRACE_GET_OPTIONS_BATCH:{
+			ST::OptionBatch batch = storyTree->getOptionsBatch(call.characters, call.numOfOptions);
+			for (unsigned int i = 0; i < call.characters.size(); i++){
+				same = same && (batch.getOptions(i) == call.options[i]);
+			}
+			kind = &getOptionsBatch;
+			break;
+		}
+		case ST::TRACE_EXECUTE_ACTION:
+			storyTree->executeAction(call.characters[0], call.path);
+			kind = &executeAction;
+			break;
+		case ST::TRACE_SET_SEED:
+			storyTree->setSeed(call.seed);
+			break;
+		case ST::TRACE_SET_CONVERSATION_TYPE:
+			storyTree->setConversationType(call.conversationType);
+			break;
+		case ST::TRACE_SET_CACHE_ENABLED:
+			storyTree->setCacheEnabled(call.enabled);
+			break;
+		}
+		if (kind != NULL){
+			kind->times.push_back(nowUs() - start);
+			if (!same){
+				kind->divergent++;
+				if (firstDivergent < 0){
+					firstDivergent = calls;
+				}
+			}
+		}
+		calls++;
+	}
+	delete storyTree;
+	if (!reader.getError().empty()){
+		cerr << "StoryTreeBench error: " << reader.getError() << endl;
+		return 1;
+	}
+
+	const char* names[] = { "getOptions", "getOptionsBatch", "executeAction" };
+	ReplayTimes* kinds[] = { &getOptions, &getOptionsBatch, &executeAction };
+	out << "{\"benchmark\": \"StoryTreeBench\", \"replay\": \"" << tracePath << "\", \"image\": \"" << imagePath
+		<< "\",\n  \"imageLoadMs\": " << imageLoadMs << ", \"calls\": " << calls
+		<< ", \"divergent\": " << (getOptions.divergent + getOptionsBatch.divergent) << ", \"firstDivergentCall\": " << firstDivergent;
+	for (int i = 0; i < 3; i++){
+		vector<double>& times = kinds[i]->times;
+		sort(times.begin(), times.end());
+		double total = 0;
+		for (auto& time : times){
+			total += time;
+		}
+		out << ",\n  \"" << names[i] << "\": {\"calls\": " << times.size() << ", \"divergent\": " << kinds[i]->divergent
+			<< ", \"meanUs\": " << total / max<size_t>(times.size(), 1) << ", \"p50Us\": " << percentile(times, 0.5)
+			<< ", \"p90Us\": " << percentile(times, 0.9) << ", \"p99Us\": " << percentile(times, 0.99)
+			<< ", \"maxUs\": " << (times.empty() ? 0 : times.back()) << "}";
+	}
+	out << "}" << endl;
+	return 0;
+}
+
+static void writeResult(ostream& out, const BenchConfig& config, const BenchResult& result){
+	const WorldSpec& spec = config.spec;
+	out << "    {\"name\": \"" << config.name << "\", \"seed\": " << spec.seed
+		<< ", \"characters\": " << spec.characters << ", \"classes\": " << spec.classes
+		<< ", \"typesPerClass\": " << spec.typesPerClass << ", \"depth\": " << spec.depth
+		<< ", \"branching\": " << spec.branching << ", \"sharing\": " << spec.sharing
+		<< ", \"preconditions\": " << spec.preconditions << ", \"expressions\": " << spec.expressions
+		<< ", \"actions\": " << result.actions
+		<< ",\n     \"loadMs\": " << result.loadMs << ", \"imageLoadMs\": " << result.imageLoadMs
+		<< ", \"bytesPerCharacter\": " << result.bytesPerCharacter
+		<< ",\n     \"getOptions\": {\"calls\": " << result.calls << ", \"meanUs\": " << result.meanUs
+		<< ", \"p50Us\": " << result.p50Us << ", \"p90Us\": " << result.p90Us
+		<< ", \"p99Us\": " << result.p99Us << ", \"maxUs\": " << result.maxUs << "}"
+		<< ",\n     \"executeAction\": {\"calls\": " << result.executes
+		<< ", \"perSecond\": " << result.executesPerSecond << "}";
+
+	const ST::MemoryReport& memory = result.memory;
+	out << ",\n     \"memory\": {\"heapBytes\": " << memory.total() << ", \"sdb\": " << memory.sdb << ", \"symbols\": " << memory.symbols
+		<< ", \"characters\": " << memory.characters << ", \"dependencies\": " << memory.dependencies
+		<< ", \"optionCache\": " << memory.optionCache << ", \"scratch\": " << memory.scratch;
+	if (!memory.perCharacter.empty()){
+		const ST::CharacterMemoryUsage& largest = memory.perCharacter[0];
+		out << ", \"largestCharacter\": {\"name\": \"" << largest.name << "\", \"values\": " << largest.values
+			<< ", \"actionTree\": " << largest.actionTree << ", \"compiledTree\": " << largest.compiledTree
+			<< ", \"memoryBank\": " << largest.memoryBank << "}";
+	}
+	out << "}";
+	if (config.allocations){
+		out << ",\n     \"allocations\": {\"trackedBytes\": " << result.trackedBytes
+			<< ", \"perGetOptions\": " << result.allocationsPerGetOptions << ", \"retainedBytes\": " << result.retainedBytes
+			<< ", \"perExecuteAction\": " << result.allocationsPerExecute << "}";
+	}
+	out << "}";
+}
+
+int main(int argc, char* argv[])
+{
+	vector<BenchConfig> configs;
+	BenchConfig custom = preset("custom");
+	bool customWorld = false;
+	bool customCalls = false;
+	bool customExecutes = false;
+	string presetName;
+	string outPath;
+	string replayPath;
+	string imagePath;
+
+	for (int i = 1; i < argc; i++){
+		string arg = argv[i];
+		size_t equals = arg.find('=');
+		if (arg.compare(0, 2, "--") != 0 || equals == string::npos){
+			cerr << "StoryTreeBench error: Options look like --name=value, not " << arg << endl;
+			return 1;
+		}
+		string name = arg.substr(2, equals - 2);
+		string value = arg.substr(equals + 1);
+		unsigned int number = (unsigned int)strtoul(value.c_str(), NULL, 10);
+		float fraction = (float)atof(value.c_str());
+
+		if (name == "preset")				{ presetName = value; }
+		else if (name == "out")				{ outPath = value; }
+		else if (name == "replay")			{ replayPath = value; }
+		else if (name == "image")			{ imagePath = value; }
+		else if (name == "record")			{ custom.recordPath = value; }
+		else if (name == "timeline")		{ custom.timelinePath = value; }
+		else if (name == "allocations")		{ custom.allocations = (number != 0); }
+		else if (name == "calls")			{ custom.calls = number; customCalls = true; }
+		else if (name == "executes")		{ custom.executes = number; customExecutes = true; }
+		else if (name == "seed")			{ custom.spec.seed = number; }
+		else if (name == "characters")		{ custom.spec.characters = number; customWorld = true; }
+		else if (name == "classes")			{ custom.spec.classes = number; customWorld = true; }
+		else if (name == "types")			{ custom.spec.typesPerClass = number; customWorld = true; }
+		else if (name == "depth")			{ custom.spec.depth = number; customWorld = true; }
+		else if (name == "branching")		{ custom.spec.branching = number; customWorld = true; }
+		else if (name == "sharing")			{ custom.spec.sharing = fraction; customWorld = true; }
+		else if (name == "preconditions")	{ custom.spec.preconditions = fraction; customWorld = true; }
+		else if (name == "expressions")		{ custom.spec.expressions = fraction; customWorld = true; }
+		else {
+			cerr << "StoryTreeBench error: There's no option called " << name << endl;
+			return 1;
+		}
+	}
+
+	ofstream file;
+	if (!outPath.empty()){
+		file.open(outPath.c_str());
+		if (!file){
+			cerr << "StoryTreeBench error: Couldn't open " << outPath << endl;
+			return 1;
+		}
+	}
+	ostream& out = outPath.empty() ? cout : file;
+
+	if (!replayPath.empty()){
+		return replay(replayPath, imagePath.empty() ? replayPath + ".stim" : imagePath, out);
+	}
+
+	if (customWorld){
+		configs.push_back(custom);
+	}
+	else {
+		const char* presets[] = { "small", "medium", "large" };
+		for (auto& name : presets){
+			if (presetName.empty() || presetName == name){
+				BenchConfig config = preset(name);
+				config.spec.seed = custom.spec.seed;
+				config.recordPath = custom.recordPath;
+				config.timelinePath = custom.timelinePath;
+				config.allocations = custom.allocations;
+				//A preset's own call counts only stand when none were asked for
+				if (customCalls){
+					config.calls = custom.calls;
+				}
+				if (customExecutes){
+					config.executes = custom.executes;
+				}
+				configs.push_back(config);
+			}
+		}
+	}
+	for (auto& config : configs){
+		if (config.spec.characters == 0 || config.spec.classes == 0 || config.spec.typesPerClass == 0 || config.spec.depth == 0 || config.spec.branching == 0){
+			cerr << "StoryTreeBench error: characters, classes, types, depth and branching have to be at least 1" << endl;
+			return 1;
+		}
+	}
+	if (configs.empty()){
+		cerr << "StoryTreeBench error: There's no preset called " << presetName << endl;
+		return 1;
+	}
+
+	if (configs.size() > 1){
+		for (auto& config : configs){
+			if (!config.recordPath.empty()){
+				config.recordPath += "." + config.name;
+			}
+			if (!config.timelinePath.empty()){
+				config.timelinePath += "." + config.name;
+			}
+		}
+	}
+
+	vector<BenchResult> results;
+	for (auto& config : configs){
+		cerr << "Running " << config.name << "..." << endl;
+		results.push_back(run(config));
+	}
+
+	out << "{\"benchmark\": \"StoryTreeBench\",\n  \"results\": [\n";
+	for (size_t i = 0; i < configs.size(); i++){
+		writeResult(out, configs[i], results[i]);
+		out << ((i + 1 < configs.size()) ? ",\n" : "\n");
+	}
+	out << "  ]}" << endl;
+
+	return 0;
+}
@@ -0,0 +1,177 @@
+//WorldGenerator.cpp
+#include "stdafx.h"
+#include "WorldGenerator.h"
+
+#include <vector>
+
+//Integer classes all run from 0 to 10
+static const int WORLD_MIN = 0;
+static const int WORLD_MAX = 10;
+static const unsigned int WORLD_TOPICS = 8;
+
+WorldGenerator::WorldGenerator(const WorldSpec& spec)
+{
+	this->spec = spec;
+	this->rng.seed(spec.seed);
+}
+
+
+WorldGenerator::~WorldGenerator()
+{
+}
+
+//Adds the SDB, the characters, about half of each character's values and every character's actions.
+//Each character's actions are a DAG spec.depth levels deep. An action's children are new actions on the
+//next level, or with chance spec.sharing ones that level already has, so sharing makes more parents per action
+void WorldGenerator::generate(ST::StoryTree& storyTree){
+	for (unsigned int cls = 0; cls < this->spec.classes; cls++){
+		std::vector<std::string> types;
+		for (unsigned int type = 0; type < this->spec.typesPerClass; type++){
+			types.push_back(this->getTypeName(type));
+		}
+		if (this->isBoolean(cls)){
+			storyTree.addSDBClass(ST::SDBClass(this->getClassName(cls), types, false));
+		}
+		else {
+			storyTree.addSDBClass(ST::SDBClass(this->getClassName(cls), types, (WORLD_MIN + WORLD_MAX) / 2, WORLD_MIN, WORLD_MAX));
+		}
+	}
+
+	for (unsigned int character = 0; character < this->spec.characters; character++){
+		storyTree.addCharacter(this->getCharacterName(character));
+	}
+	for (unsigned int character = 0; character < this->spec.characters; character++){
+		for (unsigned int cls = 0; cls < this->spec.classes; cls++){
+			for (unsigned int type = 0; type < this->spec.typesPerClass; type++){
+				if (!this->chance(0.5f)){
+					continue;
+				}
+				if (this->isBoolean(cls)){
+					storyTree.addCharacteristic(ST::Characteristic(this->getCharacterName(character), this->getClassName(cls), this->getTypeName(type), this->chance(0.5f)));
+				}
+				else {
+					int value = WORLD_MIN + (int)this->next(WORLD_MAX - WORLD_MIN + 1);
+					storyTree.addCharacteristic(ST::Characteristic(this->getCharacterName(character), this->getClassName(cls), this->getTypeName(type), value));
+				}
+			}
+		}
+	}
+
+	int uid = 0;
+	for (unsigned int character = 0; character < this->spec.characters; character++){
+		//Every action is built before any is added, since a StoryTree copies them
+		std::vector<ST::Action> actions;
+		std::vector<unsigned int> level;
+		for (unsigned int first = 0; first < this->spec.branching; first++){
+			uid++;
+			std::string topic = "topic" + std::to_string(this->next(WORLD_TOPICS));
+			level.push_back(actions.size());
+			actions.push_back(ST::Action("action" + std::to_string(uid), uid, true, topic));
+		}
+
+		for (unsigned int depth = 1; depth < this->spec.depth; depth++){
+			std::vector<unsigned int> nextLevel;
+			for (auto& parent : level){
+				for (unsigned int child = 0; child < this->spec.branching; child++){
+					if (!nextLevel.empty() && this->chance(this->spec.sharing)){
+						unsigned int shared = nextLevel[this->next(nextLevel.size())];
+						actions[parent].addChild(actions[shared].getUID());
+						continue;
+					}
+					uid++;
+					nextLevel.push_back(actions.size());
+					actions[parent].addChild(uid);
+					actions.push_back(ST::Action("action" + std::to_string(uid), uid));
+				}
+			}
+			level.swap(nextLevel);
+		}
+
+		for (auto& action : actions){
+			unsigned int preconditions = this->count(this->spec.preconditions);
+			for (unsigned int i = 0; i < preconditions; i++){
+				action.addPrecondition(this->makePrecondition(character));
+			}
+			unsigned int expressions = this->count(this->spec.expressions);
+			for (unsigned int i = 0; i < expressions; i++){
+				action.addExpression(this->makeExpression(character));
+			}
+			storyTree.addAction(this->getCharacterName(character), action);
+		}
+		this->actionCount += actions.size();
+	}
+}
+
+std::string WorldGenerator::getCharacterName(unsigned int character) const{
+	return "character" + std::to_string(character);
+}
+
+unsigned int WorldGenerator::getActionCount() const{
+	return this->actionCount;
+}
+
+//std::uniform_int_distribution differs between standard libraries, so the same seed wouldn't give the same world
+unsigned int WorldGenerator::next(unsigned int n){
+	return (unsigned int)(this->rng() % n);
+}
+
+bool WorldGenerator::chance(float probability){
+	return this->rng() < probability * 4294967296.0;
+}
+
+//average rounded down, plus one with the chance of its fraction
+unsigned int WorldGenerator::count(float average){
+	unsigned int whole = (unsigned int)average;
+	return whole + (this->chance(average - whole) ? 1 : 0);
+}
+
+std::string WorldGenerator::getClassName(unsigned int cls) const{
+	return "class" + std::to_string(cls);
+}
+
+std::string WorldGenerator::getTypeName(unsigned int type) const{
+	return "type" + std::to_string(type);
+}
+
+bool WorldGenerator::isBoolean(unsigned int cls) const{
+	return (cls % 4) == 3;
+}
+
+//Mostly the owner, otherwise anyone
+std::string WorldGenerator::pickCharacter(unsigned int owner){
+	if (this->chance(0.7f)){
+		return this->getCharacterName(owner);
+	}
+	return this->getCharacterName(this->next(this->spec.characters));
+}
+
+ST::Precondition WorldGenerator::makePrecondition(unsigned int owner){
+	std::string character = this->pickCharacter(owner);
+	unsigned int cls = this->next(this->spec.classes);
+	std::string type = this->getTypeName(this->next(this->spec.typesPerClass));
+	if (this->isBoolean(cls)){
+		return ST::Precondition(character, this->getClassName(cls), type, this->chance(0.5f));
+	}
+
+	//Bounds mostly fall on the far side of the middle, so most comparisons hold and traversals get
+	//past the first level, as they do in written stories
+	int half = (WORLD_MAX - WORLD_MIN) / 2;
+	unsigned int kind = this->next(5);
+	if (kind == 0){
+		return ST::Precondition(character, this->getClassName(cls), type, "==", WORLD_MIN + (int)this->next(WORLD_MAX - WORLD_MIN + 1));
+	}
+	else if (kind <= 2){
+		return ST::Precondition(character, this->getClassName(cls), type, "<", WORLD_MAX - (int)this->next(half));
+	}
+	return ST::Precondition(character, this->getClassName(cls), type, ">", WORLD_MIN + (int)this->next(half));
+}
+
+ST::Expression WorldGenerator::makeExpression(unsigned int owner){
+	std::string character = this->pickCharacter(owner);
+	unsigned int cls = this->next(this->spec.classes);
+	std::string type = this->getTypeName(this->next(this->spec.typesPerClass));
+	if (this->isBoolean(cls)){
+		return ST::Expression(character, this->getClassName(cls), type, this->chance(0.5f));
+	}
+	return ST::Expression(character, this->getClassName(cls), type, this->chance(0.5f) ? "+" : "-", 1 + (int)this->next(3));
+}
@@ -0,0 +1,53 @@
+//WorldGenerator.h
+#ifndef WorldGenerator_H
+#define WorldGenerator_H
+
+#include "StoryTreeLib.h"
+
+#include <random>
+#include <string>
+
+//How big a world WorldGenerator makes
+struct WorldSpec{
+	unsigned int						characters = 20;
+	unsigned int						classes = 8;			//every fourth one is boolean
+	unsigned int						typesPerClass = 4;
+	unsigned int						depth = 4;				//levels of actions, the firsts being the first level
+	unsigned int						branching = 3;			//firsts per character and children per action
+	float								sharing = 0.2f;			//chance a child is an action its level already has
+	float								preconditions = 1.5f;	//average per action
+	float								expressions = 1.0f;		//average per action
+	unsigned int						seed = 1;
+};
+
+//Fills a StoryTree with a made up world of a given size through the public API, the same world
+//for the same spec and seed on every platform
+class WorldGenerator
+{
+public:
+	WorldGenerator(const WorldSpec& spec);
+	~WorldGenerator();
+
+	void								generate(ST::StoryTree& storyTree);
+
+	std::string							getCharacterName(unsigned int character) const;
+	unsigned int						getActionCount() const;
+
+private:
+	WorldSpec							spec;
+	std::mt19937						rng;
+	unsigned int						actionCount = 0;
+
+	//private functions for generate
+	unsigned int						next(unsigned int n);
+	bool								chance(float probability);
+	unsigned int						count(float average);
+	std::string							getClassName(unsigned int cls) const;
+	std::string							getTypeName(unsigned int type) const;
+	bool								isBoolean(unsigned int cls) const;
+	std::string							pickCharacter(unsigned int owner);
+	ST::Precondition					makePrecondition(unsigned int owner);
+	ST::Expression						makeExpression(unsigned int owner);
+};
+
+#endif